@@ -4,44 +4,117 @@
 #include <sys/mman.h>   
 #include <sys/stat.h>
 #include <unistd.h>
+#include <array>
 #include <string>
+#include <vector>
+#include <string_view>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <charconv>
+#include <sstream>
 #include <iostream>
+#include <iomanip>
+#include <cassert>
+#include <type_traits>
 
+// regular files are mmapped whole, anything else (pipes, terminals) is read in chunks into an aligned buffer;
+// every scan goes through avail(), which is a plain p < end check unless a chunk runs out
 class FastIO {
-    char* p;
-    char* end;
+    static constexpr size_t CHUNK = 1 << 18;
+    char* p = nullptr;
+    char* end = nullptr;
+    char* map = nullptr;
+    char* buf = nullptr;
+    size_t map_size = 0;
+    bool eof = false;
+
+    bool refill() {
+        if (!buf || eof) return false;
+        ssize_t n;
+        do n = ::read(0, buf, CHUNK); while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            eof = true;
+            p = end = buf;
+            return false;
+        }
+        p = buf;
+        end = buf + n;
+        return true;
+    }
+    inline bool avail() { return p < end || refill(); }
+    inline void skipSpace() { while (avail() && *p <= ' ') p++; }
+
+    // stream mode: keep the unread tail and read until k bytes are buffered or input ends
+    bool topup(size_t k) {
+        if (!buf) return false;
+        size_t have = end - p;
+        memmove(buf, p, have);
+        p = buf;
+        end = buf + have;
+        while (!eof && have < k) {
+            ssize_t n = ::read(0, end, CHUNK - have);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { eof = true; break; }
+            end += n;
+            have += n;
+        }
+        return have >= k;
+    }
+
+    // SWAR: counts the leading digits of the 8 bytes at q and returns their value in v
+    static inline int parse8(const char* q, unsigned long long& v) {
+        constexpr unsigned long long ONES = 0x0101010101010101ULL;
+        unsigned long long x;
+        memcpy(&x, q, 8);
+        x ^= ONES * '0';
+        unsigned long long bad = (((x & ONES * 0x7f) + ONES * 0x76) | x) & ONES * 0x80;
+        int k = bad ? __builtin_ctzll(bad) >> 3 : 8;
+        if (k == 0) return v = 0, 0;
+        x <<= (8 - k) * 8;
+        x = (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+        x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x * 10000 + (x >> 32)) & 0xFFFFFFFFULL;
+        v = x;
+        return k;
+    }
+
+    static constexpr int WINDOW = 32; // sign and 24 digits are parsed without bounds checks
+
 public:
     FastIO() {
         struct stat st;
-        fstat(0, &st);
-        if (st.st_size == 0) {
-            p = end = nullptr;
-        } else {
-            p = (char*)mmap(0, st.st_size, PROT_READ, MAP_SHARED, 0, 0);
-            if (p == MAP_FAILED)
-                p = end = nullptr;
-            else 
-                end = p + st.st_size;
+        if (fstat(0, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* m = mmap(0, st.st_size, PROT_READ, MAP_SHARED, 0, 0);
+            if (m != MAP_FAILED) {
+                map = p = (char*)m;
+                end = map + st.st_size;
+                map_size = st.st_size;
+                return;
+            }
         }
+        buf = (char*)std::aligned_alloc(4096, CHUNK);
+        p = end = buf;
     }
 
     ~FastIO() {
-        if (p && p != MAP_FAILED) {
-            munmap(p, end - p);
-        }
+        if (map) munmap(map, map_size);
+        std::free(buf);
     }
-    
+    FastIO(const FastIO&) = delete;
+    FastIO& operator=(const FastIO&) = delete;
+
     template <typename T>
     inline T readInt() {
         T ret = 0;
         bool neg = false;
-        while (p < end && *p <= ' ') p++;
-        if (p >= end) return 0;
+        skipSpace();
+        if (!avail()) return 0;
         if (*p == '-') {
             neg = true;
             p++;
         }
-        while (p < end && *p >= '0' && *p <= '9') 
+        while (avail() && *p >= '0' && *p <= '9') 
             ret = ret * 10 + (*p++ - '0');
         return neg ? -ret : ret;
     }
@@ -50,18 +123,18 @@ public:
     inline T readReal() {
         T ret = 0.0;
         bool neg = false;
-        while (p < end && *p <= ' ') p++;
-        if (p >= end) return 0.0;
+        skipSpace();
+        if (!avail()) return 0.0;
         if (*p == '-') {
             neg = true;
             p++;
         }
-        while (p < end && *p >= '0' && *p <= '9') 
+        while (avail() && *p >= '0' && *p <= '9') 
             ret = ret * 10 + (*p++ - '0');
-        if (p < end && *p == '.') {
+        if (avail() && *p == '.') {
             p++;
             T multiplier = 0.1;
-            while (p < end && *p >= '0' && *p <= '9') {
+            while (avail() && *p >= '0' && *p <= '9') {
                 ret += (*p++ - '0') * multiplier;
                 multiplier *= 0.1;
             }
@@ -71,35 +144,76 @@ public:
 
     template <typename T>
     inline T readByte() {
-        while (p < end && *p <= ' ') p++;
-        if (p >= end) return 0;
+        skipSpace();
+        if (!avail()) return 0;
         return *p++;
     }
 
     inline std::string readString() {
         std::string ret;
-        while (p < end && *p <= ' ') p++;
-        if (p >= end) return ret;
-        char* start = p;
-        while (p < end && *p > ' ') p++;
-        return std::string(start, p);
+        skipSpace();
+        while (avail()) {
+            char* start = p;
+            while (p < end && *p > ' ') p++;
+            ret.append(start, p);
+            if (p < end) break;
+        }
+        return ret;
     }
     
     inline std::string readLine() {
-        if (p >= end) return "";
-        char* start = p;
-        while (p < end && *p != '\n') p++;
-        char* str_end = p;
-        if (str_end > start && *(str_end - 1) == '\r')
-            str_end--;
-        std::string ret(start, str_end);
-        if (p < end) p++;      
+        std::string ret;
+        if (!avail()) return ret;
+        while (avail()) {
+            char* start = p;
+            while (p < end && *p != '\n') p++;
+            ret.append(start, p);
+            if (p < end) break;
+        }
+        if (!ret.empty() && ret.back() == '\r')
+            ret.pop_back();
+        if (avail()) p++;      
         return ret;
     }
 
     inline void ignore() {
-        while (p < end && *p != '\n') p++;
-        if (p < end) p++;
+        while (avail() && *p != '\n') p++;
+        if (avail()) p++;
+    }
+
+    // bulk integer input, T is an integer type or anything constructible from long long (mint);
+    // tokens with WINDOW bytes ahead of them are parsed eight digits at a time, the tail falls back to readInt
+    template <typename T>
+    void read_ints(T* out, size_t n) {
+        static constexpr unsigned long long pw[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+        for (size_t i = 0; i < n; i++) {
+            skipSpace();
+            if (end - p < WINDOW && !topup(WINDOW)) {
+                if constexpr (std::is_integral_v<T>) out[i] = readInt<T>();
+                else out[i] = T(readInt<long long>());
+                continue;
+            }
+            bool neg = *p == '-';
+            p += neg;
+            unsigned long long v, d;
+            int k = parse8(p, v);
+            p += k;
+            if (k == 8) {
+                k = parse8(p, d); p += k; v = v * pw[k] + d;
+                if (k == 8) {
+                    k = parse8(p, d); p += k; v = v * pw[k] + d;
+                    while (avail() && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+                }
+            }
+            if constexpr (std::is_integral_v<T>) out[i] = neg ? T(0 - v) : T(v);
+            else out[i] = T((long long)(neg ? 0 - v : v));
+        }
+    }
+    template <typename T>
+    std::vector<T> read_ints(size_t n) {
+        std::vector<T> v(n);
+        read_ints(v.data(), n);
+        return v;
     }
 
     inline FastIO& operator>>(int& x) { x = readInt<int>(); return *this; }
@@ -112,9 +226,182 @@ public:
     inline FastIO& getline(std::string& s) { s = readLine(); return *this; }
 };
 
+// buffered writer for stdout, flushed with write(1, ...) when full and once at exit
+class FastOutput {
+    static constexpr int SIZE = 1 << 20;
+    static constexpr int MARGIN = 64; // room for any single number
+    char buf[SIZE];
+    int pos = 0;
+    int prec = 6;
+    std::chars_format fmt = std::chars_format::general;
+    size_t width_ = 0; // setw, applies to the next item only
+    char fill_ = ' ';
+    bool left_ = false;
+
+    static constexpr auto pairs = [] {
+        std::array<char, 200> d{};
+        for (int i = 0; i < 100; i++) d[2 * i] = '0' + i / 10, d[2 * i + 1] = '0' + i % 10;
+        return d;
+    }();
+
+    inline void reserve(int n) { if (pos + n > SIZE) flush(); }
+
+    static inline int digits(unsigned long long x) {
+        int n = 1;
+        for (;;) {
+            if (x < 10) return n;
+            if (x < 100) return n + 1;
+            if (x < 1000) return n + 2;
+            if (x < 10000) return n + 3;
+            x /= 10000; n += 4;
+        }
+    }
+
+    // writes x at the cursor, two digits per step from the back
+    inline void writeUnsigned(unsigned long long x) {
+        int n = digits(x);
+        char* q = buf + pos + n;
+        while (x >= 100) {
+            unsigned r = x % 100; x /= 100;
+            q -= 2; memcpy(q, pairs.data() + 2 * r, 2);
+        }
+        if (x >= 10) { q -= 2; memcpy(q, pairs.data() + 2 * x, 2); }
+        else *--q = '0' + x;
+        pos += n;
+    }
+
+    inline void writeSigned(bool neg, unsigned long long u) {
+        reserve(MARGIN);
+        if (neg) buf[pos++] = '-';
+        writeUnsigned(u);
+    }
+
+    inline void fillN(size_t k) { while (k--) writeByte(fill_); }
+
+    // an item of n bytes under setw: fill on the side given by left / right, then the width resets
+    template <typename F>
+    inline void padded(size_t n, F&& write) {
+        size_t w = width_;
+        width_ = 0;
+        if (n < w && !left_) fillN(w - n);
+        write();
+        if (n < w && left_) fillN(w - n);
+    }
+
+    inline void writeText(const char* s, size_t n) {
+        if (width_) [[unlikely]] return padded(n, [&] { writeBytes(s, n); });
+        writeBytes(s, n);
+    }
+
+public:
+    FastOutput() = default;
+    ~FastOutput() { flush(); }
+    FastOutput(const FastOutput&) = delete;
+    FastOutput& operator=(const FastOutput&) = delete;
+
+    inline void flush() {
+        int done = 0;
+        while (done < pos) {
+            ssize_t w = ::write(1, buf + done, pos - done);
+            if (w <= 0) break;
+            done += w;
+        }
+        pos = 0;
+    }
+
+    template <typename T>
+    inline void writeInt(T x) {
+        unsigned long long u = x;
+        bool neg = false;
+        if constexpr (std::is_signed_v<T>) if (x < 0) neg = true, u = 0 - u;
+        if (width_) [[unlikely]] return padded(neg + digits(u), [&] { writeSigned(neg, u); });
+        writeSigned(neg, u);
+    }
+
+    template <typename T>
+    inline void writeReal(T x) {
+        char tmp[512];
+        auto r = std::to_chars(tmp, tmp + sizeof tmp, x, fmt, fmt == std::chars_format::general && !prec ? 1 : prec);
+        writeText(tmp, r.ptr - tmp);
+    }
+
+    inline void writeByte(char c) { reserve(1); buf[pos++] = c; }
+
+    inline void writeBytes(const char* s, size_t n) {
+        if (pos + n > (size_t)SIZE) {
+            flush();
+            if (n > (size_t)SIZE) { // too large to buffer, pass it through
+                while (n) {
+                    ssize_t w = ::write(1, s, n);
+                    if (w <= 0) return;
+                    s += w; n -= w;
+                }
+                return;
+            }
+        }
+        memcpy(buf + pos, s, n);
+        pos += n;
+    }
+
+    // iostream style state used by set_decimal
+    inline int precision(int p) { int old = prec; prec = p; return old; }
+    inline int precision() const { return prec; }
+
+    inline FastOutput& operator<<(char c) { writeText(&c, 1); return *this; }
+    inline FastOutput& operator<<(bool b) { char c = '0' + b; writeText(&c, 1); return *this; }
+    inline FastOutput& operator<<(const char* s) { writeText(s, strlen(s)); return *this; }
+    inline FastOutput& operator<<(std::string_view s) { writeText(s.data(), s.size()); return *this; }
+    inline FastOutput& operator<<(const std::string& s) { writeText(s.data(), s.size()); return *this; }
+    inline FastOutput& operator<<(std::ios_base& (*f)(std::ios_base&)) {
+        if (f == std::fixed) fmt = std::chars_format::fixed;
+        else if (f == std::scientific) fmt = std::chars_format::scientific;
+        else if (f == std::defaultfloat) fmt = std::chars_format::general;
+        else if (f == std::left) left_ = true;
+        else if (f == std::right) left_ = false;
+        else assert(!"FastOutput: unsupported manipulator");
+        return *this;
+    }
+    inline FastOutput& operator<<(std::ostream& (*f)(std::ostream&)) {
+        if (f == static_cast<std::ostream& (*)(std::ostream&)>(std::flush)) flush();
+        else writeByte('\n');
+        return *this;
+    }
+
+    // integers and floats, mint-like types through val(), setprecision / setw / setfill read back off a
+    // scratch ostream, anything else through its ostream operator
+    template <typename T>
+    inline FastOutput& operator<<(const T& x) {
+        if constexpr (std::is_integral_v<T>) writeInt(x);
+        else if constexpr (std::is_floating_point_v<T>) writeReal(x);
+        else if constexpr (requires { { x.val() } -> std::integral; }) writeInt(x.val());
+        else if constexpr (std::is_same_v<T, decltype(std::setprecision(0))>) { std::ostringstream os; os << x; prec = os.precision(); }
+        else if constexpr (std::is_same_v<T, decltype(std::setw(0))>) { std::ostringstream os; os << x; width_ = std::max<std::streamsize>(os.width(), 0); }
+        else if constexpr (std::is_same_v<T, decltype(std::setfill(' '))>) { std::ostringstream os; os << x; fill_ = os.fill(); }
+        else {
+            static_assert(!std::is_same_v<T, decltype(std::setbase(0))> &&
+                          !std::is_same_v<T, decltype(std::setiosflags({}))> &&
+                          !std::is_same_v<T, decltype(std::resetiosflags({}))>, "FastOutput: unsupported manipulator");
+            std::ostringstream os;
+            if (fmt == std::chars_format::fixed) os << std::fixed;
+            else if (fmt == std::chars_format::scientific) os << std::scientific;
+            if (left_) os << std::left;
+            os.precision(prec);
+            os.fill(fill_);
+            os.width(width_);
+            width_ = 0;
+            os << x;
+            std::string t = os.str();
+            writeBytes(t.data(), t.size());
+        }
+        return *this;
+    }
+};
+
 static FastIO _fast_io_instance;
+static FastOutput _fast_out_instance;
 
 #define cin _fast_io_instance
+#define cout _fast_out_instance
 #define fastio 42 // Redefined existing macro
 
 #endif
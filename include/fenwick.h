@@ -2,23 +2,33 @@
 #define FENWICK_H
 
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <iostream>
+#include <span>
+#include <utility>
+#include "include/threadpool.h"
 
-template <typename T>
+/**
+ * @brief Fenwick Tree (point add, prefix / range sum)
+ * @tparam T Value type
+ * @tparam shadow Keep a copy of the point values (O(1) get_value); false halves the memory
+ */
+template <typename T, bool shadow = true>
 class Fenwick {
 private:
     std::vector<T> arr;
     std::vector<T> tree;
-    inline unsigned size() const { return arr.size(); }
+    inline unsigned size() const { return tree.size(); }
     void _update(int idx, T val) {
-        arr[idx] += val;
+        if constexpr (shadow) arr[idx] += val;
         while(idx < size()) {
             tree[idx] += val;
             idx = idx + (idx & -idx);
         }
     }
     void _set(int idx, T val) {
-        T cur = arr[idx];
+        T cur = _get_value(idx);
         T delta = val - cur;
         _update(idx, delta);
     }
@@ -31,18 +41,41 @@ private:
         return sum;
     }
     T _get_range(int l, int r) { return _get_prefix(r) - _get_prefix(l - 1); }
+    T _get_value(int idx) {
+        if constexpr (shadow) return arr[idx];
+        T val = tree[idx];
+        int stop = idx - (idx & -idx);
+        for(int i = idx - 1; i > stop; i -= i & -i) val -= tree[i];
+        return val;
+    }
+    // turns point values into tree nodes in place, O(n)
+    static void _build(std::vector<T> &t) {
+        for(int i = 1; i < t.size(); i++) {
+            int j = i + (i & -i);
+            if(j < t.size()) t[j] += t[i];
+        }
+    }
+    // inverse of _build: the point values, O(n)
+    std::vector<T> _values() {
+        if constexpr (shadow) return arr;
+        std::vector<T> v = tree;
+        for(int i = size() - 1; i >= 1; i--) {
+            int j = i + (i & -i);
+            if(j < size()) v[j] -= v[i];
+        }
+        return v;
+    }
 
 public:
     /**
-     * @brief Constructor for Fenwick Tree
+     * @brief Constructor for Fenwick Tree, O(n)
      * @param input Input array (1-indexed)
      */
-    Fenwick(std::vector<T> &input) {
-        arr.resize(input.size() + 1, 0);
+    Fenwick(const std::vector<T> &input) {
         tree.resize(input.size() + 1, 0);
-        for(int i = 1; i < input.size(); i++) {
-            _update(i, input[i]);
-        }
+        for(int i = 1; i < input.size(); i++) tree[i] = input[i];
+        if constexpr (shadow) arr = tree;
+        _build(tree);
     }
     /**
      * @brief Function to update the Fenwick Tree
@@ -72,11 +105,72 @@ public:
      */
     T get_range(int l, int r) { return _get_range(l, r); }
     /**
-     * @brief Function to get value at idx
+     * @brief Function to get value at idx, O(log n) without the shadow array
      * @param idx Index to get value at (1-indexed)
      * @return int Value at idx
      */
-    T get_value(int idx) { return arr[idx]; }
+    T get_value(int idx) { return _get_value(idx); }
+    /**
+     * @brief Function to find the first prefix reaching sum (values must be non-negative)
+     * @param sum Target prefix sum
+     * @return int Smallest idx with get_prefix(idx) >= sum, or the tree size if there is none
+     */
+    int lower_bound(T sum) {
+        int pos = 0;
+        for(int step = std::__lg(size()); step >= 0; step--) {
+            int nxt = pos + (1 << step);
+            if(nxt < size() && tree[nxt] < sum) {
+                pos = nxt;
+                sum -= tree[nxt];
+            }
+        }
+        return pos + 1;
+    }
+    /**
+     * @brief Function to answer many range sums at once (read-only, split across parallel::for_range)
+     * @param qs Ranges (l, r), 1-indexed and inclusive, clamped to [1, n] like Segtree::get_many (empty gives 0)
+     * @return std::vector<T> Range sums in the order of qs
+     * @note A batch of at least size() / 4 queries is answered from a prefix sum array built in O(n)
+     */
+    std::vector<T> get_many(std::span<const std::pair<int, int>> qs) {
+        std::vector<T> res(qs.size(), 0);
+        const int n = size() - 1;
+        if(qs.size() * 4 < size()) {
+            parallel::for_range(0, qs.size(), 1 << 14, [&](size_t lo, size_t hi) {
+                for(size_t i = lo; i < hi; i++) {
+                    int l = std::max(qs[i].first, 1), r = std::min(qs[i].second, n);
+                    if(l <= r) res[i] = _get_range(l, r);
+                }
+            });
+            return res;
+        }
+        std::vector<T> prefix = _values();
+        for(int i = 1; i < size(); i++) prefix[i] += prefix[i - 1];
+        parallel::for_range(0, qs.size(), 1 << 14, [&](size_t lo, size_t hi) {
+            for(size_t i = lo; i < hi; i++) { // branch-free clamp, an empty range ends up as r = l - 1
+                int l = std::clamp(qs[i].first, 1, n + 1), r = std::clamp(qs[i].second, l - 1, n);
+                res[i] = prefix[r] - prefix[l - 1];
+            }
+        });
+        return res;
+    }
+    /**
+     * @brief Function to apply many updates at once
+     * @param ups Pairs (idx, val), each adding val at idx (1-indexed)
+     * @return void
+     * @note A batch touching most of the tree is built as a tree of its own in O(n) and added node by node
+     */
+    void update_many(std::span<const std::pair<int, T>> ups) {
+        if(ups.size() * std::__lg(size()) < size()) {
+            for(auto &[idx, val] : ups) _update(idx, val);
+            return;
+        }
+        std::vector<T> delta(size(), 0);
+        for(auto &[idx, val] : ups) delta[idx] += val;
+        if constexpr (shadow) for(int i = 1; i < size(); i++) arr[i] += delta[i];
+        _build(delta);
+        for(int i = 1; i < size(); i++) tree[i] += delta[i];
+    }
     /**
      * @brief Function to print the Fenwick Tree (for debugging, dummy is truncated)
      */
@@ -95,7 +189,7 @@ public:
     void print_array() {
         using namespace std;
         bool f = true;
-        for(auto &x : arr) {
+        for(auto &x : _values()) {
             if(f) {f = false; continue;}
             cout << x << " ";
         }
@@ -103,4 +197,238 @@ public:
     }
 };
 
+/**
+ * @brief Fenwick Tree with range add and range sum, kept as two trees over the difference array
+ * @tparam T Value type
+ */
+template <typename T>
+class RangeFenwick {
+private:
+    Fenwick<T, false> b1, b2; // prefix(i) = i * sum(b1, i) - sum(b2, i)
+    static std::vector<T> _diff(const std::vector<T> &input, bool weighted) {
+        std::vector<T> d(input.size(), 0);
+        for(int i = 1; i < input.size(); i++) {
+            d[i] = input[i] - (i > 1 ? input[i - 1] : T(0));
+            if(weighted) d[i] *= T(i - 1);
+        }
+        return d;
+    }
+
+public:
+    /**
+     * @brief Constructor for Range Fenwick Tree, O(n)
+     * @param input Input array (1-indexed)
+     */
+    RangeFenwick(const std::vector<T> &input) : b1(_diff(input, false)), b2(_diff(input, true)) {}
+    /**
+     * @brief Function to add val on [l, r]
+     * @param l Left index (1-indexed)
+     * @param r Right index (1-indexed)
+     * @param val Value to add
+     * @return void
+     */
+    void update(int l, int r, T val) {
+        b1.update(l, val);
+        b1.update(r + 1, -val);
+        b2.update(l, val * T(l - 1));
+        b2.update(r + 1, -val * T(r));
+    }
+    /**
+     * @brief Function to get prefix sum up to idx
+     * @param idx Index to get sum up to (1-indexed)
+     * @return T Prefix sum
+     */
+    T get_prefix(int idx) { return b1.get_prefix(idx) * T(idx) - b2.get_prefix(idx); }
+    /**
+     * @brief Function to get range sum from l to r
+     * @param l Left index (1-indexed)
+     * @param r Right index (1-indexed)
+     * @return T Range sum
+     */
+    T get_range(int l, int r) { return get_prefix(r) - get_prefix(l - 1); }
+    /**
+     * @brief Function to get value at idx
+     * @param idx Index to get value at (1-indexed)
+     * @return T Value at idx
+     */
+    T get_value(int idx) { return b1.get_prefix(idx); }
+};
+
+/**
+ * @brief D-dimensional Fenwick Tree (point add, box sum) over one flat array
+ * @tparam T Value type
+ * @tparam D Number of dimensions
+ */
+template <typename T, int D>
+class FenwickND {
+private:
+    std::array<int, D> dim;
+    std::vector<T> tree; // (n_0 + 1) x ... x (n_{D-1} + 1), row-major
+    template <int k>
+    void _update(const std::array<int, D> &idx, size_t off, T val) {
+        const size_t base = off * (dim[k] + 1);
+        for(int i = idx[k]; i <= dim[k]; i += i & -i) {
+            if constexpr (k + 1 == D) tree[base + i] += val;
+            else _update<k + 1>(idx, base + i, val);
+        }
+    }
+    template <int k>
+    T _get_prefix(const std::array<int, D> &idx, size_t off) {
+        T sum = 0;
+        const size_t base = off * (dim[k] + 1);
+        for(int i = idx[k]; i > 0; i -= i & -i) {
+            if constexpr (k + 1 == D) sum += tree[base + i];
+            else sum += _get_prefix<k + 1>(idx, base + i);
+        }
+        return sum;
+    }
+
+public:
+    /**
+     * @brief Constructor for D-dimensional Fenwick Tree, all zero
+     * @param n Size of each dimension (indices 1..n[k])
+     */
+    FenwickND(std::array<int, D> n) : dim(n) {
+        size_t total = 1;
+        for(int k = 0; k < D; k++) total *= dim[k] + 1;
+        tree.assign(total, 0);
+    }
+    /**
+     * @brief Function to add val at idx
+     * @param idx Point to update (1-indexed)
+     * @param val Value to add
+     * @return void
+     */
+    void update(const std::array<int, D> &idx, T val) { _update<0>(idx, 0, val); }
+    /**
+     * @brief Function to get the sum over the box [1, idx]
+     * @param idx Upper corner (1-indexed, a 0 coordinate gives an empty box)
+     * @return T Prefix sum
+     */
+    T get_prefix(const std::array<int, D> &idx) { return _get_prefix<0>(idx, 0); }
+    /**
+     * @brief Function to get the sum over the box [lo, hi] by inclusion-exclusion over 2^D corners
+     * @param lo Lower corner (1-indexed)
+     * @param hi Upper corner (1-indexed)
+     * @return T Box sum
+     */
+    T get_range(const std::array<int, D> &lo, const std::array<int, D> &hi) {
+        T sum = 0;
+        for(int mask = 0; mask < (1 << D); mask++) {
+            std::array<int, D> c;
+            bool empty = false;
+            for(int k = 0; k < D; k++) {
+                c[k] = mask >> k & 1 ? lo[k] - 1 : hi[k];
+                empty |= c[k] <= 0;
+            }
+            if(empty) continue;
+            if(__builtin_popcount(mask) & 1) sum -= get_prefix(c);
+            else sum += get_prefix(c);
+        }
+        return sum;
+    }
+};
+
+/**
+ * @brief Offline 2-D Fenwick Tree on compressed coordinates, O(P log P) memory for P update points
+ * @tparam T Value type
+ * @note Every point that will be updated must be passed to the constructor; queries may use any coordinates.
+ *       Each x-node keeps the sorted y-ranks (32-bit) of the points it covers, all nodes share flat ys / tree arrays.
+ */
+template <typename T>
+class OfflineFenwick2D {
+private:
+    std::vector<long long> xs, yv; // distinct x and y, sorted
+    std::vector<int> start;        // node i owns ys / tree [start[i], start[i + 1])
+    std::vector<int> ys;
+    std::vector<T> tree;
+    inline int nx() const { return xs.size(); }
+
+public:
+    /**
+     * @brief Constructor for the offline 2-D Fenwick Tree, all zero
+     * @param points Every (x, y) that will be passed to update
+     */
+    OfflineFenwick2D(std::vector<std::pair<long long, long long>> points) {
+        std::sort(points.begin(), points.end());
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+        for(auto &[x, y] : points) {
+            if(xs.empty() || xs.back() != x) xs.push_back(x);
+            yv.push_back(y);
+        }
+        std::sort(yv.begin(), yv.end());
+        yv.erase(std::unique(yv.begin(), yv.end()), yv.end());
+        start.assign(nx() + 2, 0);
+        std::vector<std::pair<int, int>> byy(points.size()); // (y rank, x rank)
+        for(size_t p = 0; p < points.size(); p++) {
+            int cx = std::lower_bound(xs.begin(), xs.end(), points[p].first) - xs.begin() + 1;
+            int cy = std::lower_bound(yv.begin(), yv.end(), points[p].second) - yv.begin() + 1;
+            byy[p] = {cy, cx};
+            for(int i = cx; i <= nx(); i += i & -i) start[i + 1]++;
+        }
+        for(int i = 1; i <= nx(); i++) start[i + 1] += start[i];
+        ys.resize(start[nx() + 1]);
+        std::vector<int> pos(start.begin(), start.end() - 1);
+        // appending in increasing y keeps every node sorted, only equal y's can repeat
+        std::sort(byy.begin(), byy.end());
+        for(auto &[cy, cx] : byy)
+            for(int i = cx; i <= nx(); i += i & -i) ys[pos[i]++] = cy;
+        // drop repeated y's inside every node and compact
+        int w = 0;
+        for(int i = 1; i <= nx(); i++) {
+            int b = start[i], e = start[i + 1];
+            start[i] = w;
+            for(int k = b; k < e; k++)
+                if(k == b || ys[k] != ys[k - 1]) ys[w++] = ys[k];
+        }
+        start[nx() + 1] = w;
+        ys.resize(w);
+        ys.shrink_to_fit();
+        tree.assign(w, 0);
+    }
+    /**
+     * @brief Function to add val at (x, y), which must be one of the constructor's points
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param val Value to add
+     * @return void
+     */
+    void update(long long x, long long y, T val) {
+        int c = std::lower_bound(xs.begin(), xs.end(), x) - xs.begin() + 1;
+        int r = std::lower_bound(yv.begin(), yv.end(), y) - yv.begin() + 1;
+        for(int i = c; i <= nx(); i += i & -i) {
+            const int *b = ys.data() + start[i], *e = ys.data() + start[i + 1];
+            T *t = tree.data() + start[i] - 1;
+            int m = e - b;
+            for(int j = std::lower_bound(b, e, r) - b + 1; j <= m; j += j & -j) t[j] += val;
+        }
+    }
+    /**
+     * @brief Function to get the sum over all points with px <= x and py <= y
+     * @param x X bound (inclusive)
+     * @param y Y bound (inclusive)
+     * @return T Prefix sum
+     */
+    T get_prefix(long long x, long long y) {
+        T sum = 0;
+        int c = std::upper_bound(xs.begin(), xs.end(), x) - xs.begin();
+        int r = std::upper_bound(yv.begin(), yv.end(), y) - yv.begin();
+        if(r == 0) return sum;
+        for(int i = c; i > 0; i -= i & -i) {
+            const int *b = ys.data() + start[i], *e = ys.data() + start[i + 1];
+            const T *t = tree.data() + start[i] - 1;
+            for(int j = std::upper_bound(b, e, r) - b; j > 0; j -= j & -j) sum += t[j];
+        }
+        return sum;
+    }
+    /**
+     * @brief Function to get the sum over the rectangle [x1, x2] x [y1, y2]
+     * @return T Rectangle sum
+     */
+    T get_range(long long x1, long long y1, long long x2, long long y2) {
+        if(x1 > x2 || y1 > y2) return 0;
+        return get_prefix(x2, y2) - get_prefix(x1 - 1, y2) - get_prefix(x2, y1 - 1) + get_prefix(x1 - 1, y1 - 1);
+    }
+};
+
 #endif // FENWICK_H
@@ -124,6 +124,264 @@ mint<mod> pow(const mint<mod>& a, long long k) { return a.pow(k); }
 template <long long mod>
 mint<mod> pow(const mint<mod>& a, int k) { return a.pow(k); }
 
+// Montgomery form modular integer (odd mod < 2^30), _v holds a * 2^32 % mod
+template <long long mod>
+class mmint {
+private:
+    using u32 = unsigned int;
+    using u64 = unsigned long long;
+    static_assert(mod % 2 == 1 && mod < (1LL << 30), "mmint requires odd mod < 2^30");
+
+    static constexpr u32 get_r() {
+        u32 r = mod;
+        for (int i = 0; i < 4; i++) r *= 2 - (u32)mod * r;
+        return r;
+    }
+    static constexpr u32 r = -get_r();              // -mod^{-1} mod 2^32
+    static constexpr u32 n2 = -(u64)mod % mod;      // 2^64 mod mod
+    static constexpr u32 reduce(u64 a) {
+        u32 x = (a + (u64)((u32)a * r) * mod) >> 32;
+        return x >= mod ? x - mod : x;
+    }
+    u32 _v;
+
+public:
+    constexpr mmint() noexcept : _v(0) {}
+    constexpr mmint(int a) noexcept : mmint((long long)a) {}
+    constexpr mmint(long long a) noexcept : _v(0) {
+        long long x = a % mod;
+        if (x < 0) x += mod;
+        _v = reduce((u64)x * n2);
+    }
+
+    constexpr long long val() const noexcept { return reduce(_v); }
+    constexpr mmint pow(long long k) const noexcept {
+        assert(0 <= k);
+        mmint x = *this, res = 1;
+        while (k) {
+            if (k & 1) res *= x;
+            x *= x;
+            k >>= 1;
+        }
+        return res;
+    }
+    constexpr mmint inv() const noexcept {
+        long long a = val(), b = mod;
+        long long u = 1, v = 0;
+        while (b) {
+            long long t = a / b;
+            a -= t * b; std::swap(a, b);
+            u -= t * v; std::swap(u, v);
+        }
+        assert(a == 1);
+        return mmint(u);
+    }
+    constexpr mmint operator+() const noexcept { return *this; }
+    constexpr mmint operator-() const noexcept { return mmint() - *this; }
+    constexpr mmint& operator++() noexcept { return *this += mmint(1); }
+    constexpr mmint& operator--() noexcept { return *this -= mmint(1); }
+    constexpr mmint operator++(int) noexcept {
+        mmint temp = *this;
+        ++*this;
+        return temp;
+    }
+    constexpr mmint operator--(int) noexcept {
+        mmint temp = *this;
+        --*this;
+        return temp;
+    }
+    constexpr mmint& operator+=(const mmint& a) noexcept {
+        _v += a._v;
+        if (_v >= mod) _v -= mod;
+        return *this;
+    }
+    constexpr mmint& operator-=(const mmint& a) noexcept {
+        _v += mod - a._v;
+        if (_v >= mod) _v -= mod;
+        return *this;
+    }
+    constexpr mmint& operator*=(const mmint& a) noexcept {
+        _v = reduce((u64)_v * a._v);
+        return *this;
+    }
+    constexpr mmint& operator/=(const mmint& a) noexcept {
+        return *this *= a.inv();
+    }
+
+    friend constexpr mmint operator+(mmint lhs, const mmint& rhs) { return lhs += rhs; }
+    friend constexpr mmint operator-(mmint lhs, const mmint& rhs) { return lhs -= rhs; }
+    friend constexpr mmint operator*(mmint lhs, const mmint& rhs) { return lhs *= rhs; }
+    friend constexpr mmint operator/(mmint lhs, const mmint& rhs) { return lhs /= rhs; }
+    friend constexpr bool operator==(const mmint& lhs, const mmint& rhs) { return lhs._v == rhs._v; }
+    friend constexpr bool operator!=(const mmint& lhs, const mmint& rhs) { return lhs._v != rhs._v; }
+    friend istream& operator>>(istream& is, mmint& a) {
+        long long num;
+        is >> num;
+        a = mmint(num);
+        return is;
+    }
+    friend ostream& operator<<(ostream& os, const mmint& a) {
+        return os << a.val();
+    }
+};
+
+template <long long mod>
+mmint<mod> pow(const mmint<mod>& a, long long k) { return a.pow(k); }
+template <long long mod>
+mmint<mod> pow(const mmint<mod>& a, int k) { return a.pow(k); }
+
+// runtime modulus modular integer (mod < 2^31) with Barrett reduction, modulus set by dmint<id>::set_mod
+template <int id>
+class dmint {
+private:
+    using u32 = unsigned int;
+    using u64 = unsigned long long;
+    using u128 = unsigned __int128;
+
+    static inline u32 _mod = 998244353;
+    static inline u64 _im = (u64)(-1) / 998244353 + 1; // ceil(2^64 / mod)
+    static u32 reduce(u64 z) {
+        u64 x = (u64)(((u128)z * _im) >> 64);
+        u64 y = x * _mod;
+        return (u32)(z - y + (z < y ? _mod : 0));
+    }
+    u32 _v;
+
+public:
+    static void set_mod(long long m) {
+        assert(1 <= m && m < (1LL << 31));
+        _mod = m;
+        _im = (u64)(-1) / m + 1;
+    }
+    static long long mod() { return _mod; }
+
+    dmint() noexcept : _v(0) {}
+    dmint(int a) noexcept : dmint((long long)a) {}
+    dmint(long long a) noexcept {
+        long long x = a % (long long)_mod;
+        if (x < 0) x += _mod;
+        _v = x;
+    }
+
+    long long val() const noexcept { return _v; }
+    dmint pow(long long k) const noexcept {
+        assert(0 <= k);
+        dmint x = *this, res = 1;
+        while (k) {
+            if (k & 1) res *= x;
+            x *= x;
+            k >>= 1;
+        }
+        return res;
+    }
+    dmint inv() const noexcept {
+        long long a = _v, b = _mod;
+        long long u = 1, v = 0;
+        while (b) {
+            long long t = a / b;
+            a -= t * b; std::swap(a, b);
+            u -= t * v; std::swap(u, v);
+        }
+        assert(a == 1);
+        return dmint(u);
+    }
+    dmint operator+() const noexcept { return *this; }
+    dmint operator-() const noexcept { return dmint() - *this; }
+    dmint& operator++() noexcept {
+        _v++;
+        if (_v == _mod) _v = 0;
+        return *this;
+    }
+    dmint& operator--() noexcept {
+        if (_v == 0) _v = _mod;
+        _v--;
+        return *this;
+    }
+    dmint operator++(int) noexcept {
+        dmint temp = *this;
+        ++*this;
+        return temp;
+    }
+    dmint operator--(int) noexcept {
+        dmint temp = *this;
+        --*this;
+        return temp;
+    }
+    dmint& operator+=(const dmint& a) noexcept {
+        _v += a._v;
+        if (_v >= _mod) _v -= _mod;
+        return *this;
+    }
+    dmint& operator-=(const dmint& a) noexcept {
+        _v += _mod - a._v;
+        if (_v >= _mod) _v -= _mod;
+        return *this;
+    }
+    dmint& operator*=(const dmint& a) noexcept {
+        _v = reduce((u64)_v * a._v);
+        return *this;
+    }
+    dmint& operator/=(const dmint& a) noexcept {
+        return *this *= a.inv();
+    }
+
+    friend dmint operator+(dmint lhs, const dmint& rhs) { return lhs += rhs; }
+    friend dmint operator-(dmint lhs, const dmint& rhs) { return lhs -= rhs; }
+    friend dmint operator*(dmint lhs, const dmint& rhs) { return lhs *= rhs; }
+    friend dmint operator/(dmint lhs, const dmint& rhs) { return lhs /= rhs; }
+    friend bool operator==(const dmint& lhs, const dmint& rhs) { return lhs._v == rhs._v; }
+    friend bool operator!=(const dmint& lhs, const dmint& rhs) { return lhs._v != rhs._v; }
+    friend istream& operator>>(istream& is, dmint& a) {
+        long long num;
+        is >> num;
+        a = dmint(num);
+        return is;
+    }
+    friend ostream& operator<<(ostream& os, const dmint& a) {
+        return os << a.val();
+    }
+};
+
+template <int id>
+dmint<id> pow(const dmint<id>& a, long long k) { return a.pow(k); }
+template <int id>
+dmint<id> pow(const dmint<id>& a, int k) { return a.pow(k); }
+
+// factorials, inverse factorials and inverses of 1..n for a modular integer type, grown lazily (amortized doubling)
+// and rebuilt when the modulus changes; inverses come from inv[i] = -(mod / i) * inv[mod % i] in O(n)
+template <typename T>
+struct comb {
+    static inline long long mod = -1;
+    static inline std::vector<T> _fac, _ifac, _inv;
+
+    static void reserve(int n) {
+        const long long m = T(-1).val() + 1;
+        if (mod != m) {
+            mod = m;
+            _fac.assign(2, T(1)); _ifac.assign(2, T(1));
+            _inv.assign(2, T(1)); _inv[0] = T(0);
+        }
+        int k = _fac.size();
+        if (n < k) return;
+        assert(n < mod);
+        n = std::min<long long>(std::max(n + 1, 2 * k), mod);
+        _fac.resize(n); _ifac.resize(n); _inv.resize(n);
+        for (int i = k; i < n; i++) {
+            _inv[i] = -T(mod / i) * _inv[mod % i];
+            _fac[i] = _fac[i - 1] * T(i);
+            _ifac[i] = _ifac[i - 1] * _inv[i];
+        }
+    }
+    static T fac(int n) { reserve(n); return _fac[n]; }
+    static T ifac(int n) { reserve(n); return _ifac[n]; }
+    static T inv(int n) { reserve(n); return _inv[n]; }
+    static T binom(int n, int k) {
+        if (k < 0 || k > n) return T(0);
+        reserve(n);
+        return _fac[n] * _ifac[k] * _ifac[n - k];
+    }
+};
+
 #endif // MINT_H
 
 // End of mint.h
\ No newline at end of file
@@ -0,0 +1,183 @@
+#ifndef ORDERED_SET_H
+#define ORDERED_SET_H // order-statistic set on sorted buckets
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <bit>
+
+// Sorted elements cut into contiguous buckets of at most SPLIT elements. A bucket is found by binary search
+// over the bucket maxima, and a Fenwick tree over the bucket sizes turns ranks into buckets and back.
+// insert / erase shift at most SPLIT elements; the Fenwick tree is rebuilt in O(n / SPLIT) only when a bucket
+// is split or dropped, once every SPLIT / 2 updates or so. All of it lives in flat arrays, no tree nodes.
+// multi = true keeps duplicates, erase(x) then removes a single copy.
+// Unlike a node-based tree, insert and erase invalidate every outstanding iterator (elements shift inside
+// a bucket, buckets are split or dropped); only the iterator they return is valid afterwards.
+template <typename T, typename Compare = std::less<T>, bool multi = false>
+class sorted_set {
+private:
+    static constexpr size_t SPLIT = 2048; // a bucket growing past this is halved
+    std::vector<std::vector<T>> bk;
+    std::vector<size_t> fw; // Fenwick tree over bk[j].size(), 1-indexed
+    size_t cnt = 0;
+    Compare cmp;
+
+    void _rebuild() {
+        fw.assign(bk.size() + 1, 0);
+        for (size_t j = 1; j <= bk.size(); j++) {
+            fw[j] += bk[j - 1].size();
+            size_t k = j + (j & -j);
+            if (k <= bk.size()) fw[k] += fw[j];
+        }
+    }
+    void _add(size_t b, long long d) {
+        for (b++; b < fw.size(); b += b & -b) fw[b] += d;
+    }
+    // elements in buckets [0, b)
+    size_t _before(size_t b) const {
+        size_t r = 0;
+        for (; b > 0; b -= b & -b) r += fw[b];
+        return r;
+    }
+
+    // first bucket whose maximum is not before x (strict: after x), or the last bucket
+    template <bool strict>
+    size_t _bucket(const T& x) const {
+        size_t lo = 0, hi = bk.size() - 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (strict ? !cmp(x, bk[mid].back()) : cmp(bk[mid].back(), x)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+public:
+    class iterator {
+        friend class sorted_set;
+        const sorted_set* s = nullptr;
+        size_t b = 0, i = 0;
+        iterator(const sorted_set* s, size_t b, size_t i) : s(s), b(b), i(i) {
+            if (b < s->bk.size() && i == s->bk[b].size()) this->b++, this->i = 0;
+        }
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+        iterator() = default;
+        const T& operator*() const { return s->bk[b][i]; }
+        const T* operator->() const { return &s->bk[b][i]; }
+        iterator& operator++() { if (++i == s->bk[b].size()) b++, i = 0; return *this; }
+        iterator& operator--() { if (i == 0) i = s->bk[--b].size(); i--; return *this; }
+        iterator operator++(int) { iterator t = *this; ++*this; return t; }
+        iterator operator--(int) { iterator t = *this; --*this; return t; }
+        bool operator==(const iterator& o) const { return b == o.b && i == o.i; }
+    };
+    using const_iterator = iterator;
+
+    sorted_set(const Compare& cmp = Compare()) : cmp(cmp) {}
+
+    size_t size() const { return cnt; }
+    bool empty() const { return cnt == 0; }
+    void clear() { bk.clear(); fw.clear(); cnt = 0; }
+    iterator begin() const { return iterator(this, 0, 0); }
+    iterator end() const { return iterator(this, bk.size(), 0); }
+
+    std::pair<iterator, bool> insert(const T& x) {
+        if (bk.empty()) {
+            bk.push_back({x});
+            cnt = 1;
+            _rebuild();
+            return {begin(), true};
+        }
+        size_t b = _bucket<multi>(x);
+        std::vector<T>& v = bk[b];
+        size_t i = (multi ? std::upper_bound(v.begin(), v.end(), x, cmp) : std::lower_bound(v.begin(), v.end(), x, cmp)) - v.begin();
+        if (!multi && i < v.size() && !cmp(x, v[i])) return {iterator(this, b, i), false};
+        v.insert(v.begin() + i, x);
+        cnt++;
+        if (v.size() > SPLIT) {
+            size_t half = v.size() / 2;
+            std::vector<T> right(v.begin() + half, v.end());
+            v.resize(half);
+            bk.insert(bk.begin() + b + 1, std::move(right));
+            _rebuild();
+            if (i >= half) b++, i -= half;
+        } else {
+            _add(b, 1);
+        }
+        return {iterator(this, b, i), true};
+    }
+    iterator erase(iterator it) {
+        size_t b = it.b, i = it.i;
+        bk[b].erase(bk[b].begin() + i);
+        cnt--;
+        if (bk[b].empty()) {
+            bk.erase(bk.begin() + b);
+            _rebuild();
+            i = 0;
+        } else {
+            _add(b, -1);
+        }
+        return iterator(this, b, i);
+    }
+    // removes one copy of x
+    bool erase(const T& x) {
+        iterator it = find(x);
+        if (it == end()) return false;
+        erase(it);
+        return true;
+    }
+
+    iterator lower_bound(const T& x) const {
+        if (bk.empty()) return end();
+        size_t b = _bucket<false>(x);
+        return iterator(this, b, std::lower_bound(bk[b].begin(), bk[b].end(), x, cmp) - bk[b].begin());
+    }
+    iterator upper_bound(const T& x) const {
+        if (bk.empty()) return end();
+        size_t b = _bucket<true>(x);
+        return iterator(this, b, std::upper_bound(bk[b].begin(), bk[b].end(), x, cmp) - bk[b].begin());
+    }
+    iterator find(const T& x) const {
+        iterator it = lower_bound(x);
+        return it != end() && !cmp(x, *it) ? it : end();
+    }
+    size_t count(const T& x) const { return order_of_key_upper(x) - order_of_key(x); }
+
+    // k-th smallest element (0-indexed), end() if k >= size()
+    iterator find_by_order(size_t k) const {
+        if (k >= cnt) return end();
+        size_t b = 0;
+        for (size_t step = std::bit_floor(bk.size()); step; step >>= 1)
+            if (b + step < fw.size() && fw[b + step] <= k) b += step, k -= fw[b];
+        return iterator(this, b, k);
+    }
+    // number of elements before x
+    size_t order_of_key(const T& x) const {
+        if (bk.empty()) return 0;
+        size_t b = _bucket<false>(x);
+        return _before(b) + (std::lower_bound(bk[b].begin(), bk[b].end(), x, cmp) - bk[b].begin());
+    }
+    // number of elements not after x
+    size_t order_of_key_upper(const T& x) const {
+        if (bk.empty()) return 0;
+        size_t b = _bucket<true>(x);
+        return _before(b) + (std::upper_bound(bk[b].begin(), bk[b].end(), x, cmp) - bk[b].begin());
+    }
+};
+
+template <typename T, typename Compare = std::less<T>>
+using sorted_multiset = sorted_set<T, Compare, true>;
+
+// same interface as the pb_ds ordered_set of pbds.h, but iterators do not survive insert / erase:
+// keep values or ranks across updates, not iterators
+#undef ordered_set
+using ordered_set = sorted_set<int>;
+using ordered_multiset = sorted_multiset<int>;
+
+#endif // ORDERED_SET_H
@@ -3,16 +3,62 @@
 
 #include <vector>
 #include <functional>
+#include <algorithm>
+#include <utility>
 
-template<typename T>
-T parametric_search(long long low, long long high, const std::function<bool(T)> condition) {
+// condition is monotone: true up to some point, false after it
+
+// floor midpoint of low < high, the difference taken unsigned so ranges wider than 2^63 do not overflow
+inline long long parametric_mid(long long low, long long high) {
+    return low + (long long)(((unsigned long long)high - (unsigned long long)low) / 2);
+}
+
+template<typename T = long long, typename F>
+T parametric_search(long long low, long long high, F&& condition) {
     // low: inclusive, high: exclusive
     while (low + 1 < high) {
-        long long mid = (low + high) / 2;
+        long long mid = parametric_mid(low, high);
+        if (condition(T(mid))) low = mid;
+        else high = mid;
+    }
+    return low;
+}
+
+// real-valued version, condition(low) true and condition(high) false; a fixed number of halvings
+// instead of an epsilon, so it terminates whatever the magnitude of the bounds
+template<typename T = double, typename F>
+T parametric_search_real(T low, T high, F&& condition, int iterations = 100) {
+    for (int it = 0; it < iterations; it++) {
+        T mid = low + (high - low) / 2;
         if (condition(mid)) low = mid;
         else high = mid;
     }
     return low;
 }
 
-#endif // PARAMETRIC_H
\ No newline at end of file
+// Parallel binary search: query i searches [low[i], high[i]) like parametric_search, all of them advance one
+// level per round. Each round calls evaluate(probes, ok) once, with probes = (mid, query id) sorted by mid;
+// it must set ok[j] to query probes[j].second's condition at probes[j].first. Sorted probes let one sweep over
+// the shared state (events applied up to mid) answer the whole round, O(log range) sweeps in total.
+template<typename E>
+std::vector<long long> parallel_binary_search(std::vector<long long> low, std::vector<long long> high, E&& evaluate) {
+    std::vector<std::pair<long long, int>> probes;
+    std::vector<char> ok;
+    while (true) {
+        probes.clear();
+        for (int i = 0; i < (int)low.size(); i++)
+            if (low[i] + 1 < high[i]) probes.emplace_back(parametric_mid(low[i], high[i]), i);
+        if (probes.empty()) break;
+        std::sort(probes.begin(), probes.end());
+        ok.assign(probes.size(), 0);
+        evaluate(probes, ok);
+        for (size_t j = 0; j < probes.size(); j++) {
+            auto [mid, i] = probes[j];
+            if (ok[j]) low[i] = mid;
+            else high[i] = mid;
+        }
+    }
+    return low;
+}
+
+#endif // PARAMETRIC_H
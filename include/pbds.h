@@ -4,6 +4,8 @@
 #include <ext/pb_ds/assoc_container.hpp>
 #include <ext/pb_ds/tree_policy.hpp>
 using namespace __gnu_pbds;
+#ifndef ORDERED_SET_H // include/ordered_set.h provides a faster ordered_set
 #define ordered_set tree<int, null_type, less<int>, rb_tree_tag,tree_order_statistics_node_update>
+#endif
 
 #endif
\ No newline at end of file
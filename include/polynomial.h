@@ -7,8 +7,14 @@
 #include <iostream>
 #include <complex>
 #include <algorithm>
+#include <memory>
+#include <atomic>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #include "include/mint.h"
+#include "include/threadpool.h"
 
 constexpr long long constexpr_pow(long long base, long long exp, long long mod) {
     long long res = 1;
@@ -22,13 +28,27 @@ constexpr long long constexpr_pow(long long base, long long exp, long long mod)
 }
 
 constexpr int find_primitive_root(long long mod) {
-    // NOT IMPLEMENTED
-    return -1;
+    if (mod == 2) return 1;
+    long long divs[20] = {};
+    int cnt = 0;
+    long long x = mod - 1;
+    for (long long d = 2; d * d <= x; d++) {
+        if (x % d) continue;
+        divs[cnt++] = d;
+        while (x % d == 0) x /= d;
+    }
+    if (x > 1) divs[cnt++] = x;
+    for (int g = 2; ; g++) {
+        bool ok = true;
+        for (int i = 0; i < cnt && ok; i++)
+            if (constexpr_pow(g, (mod - 1) / divs[i], mod) == 1) ok = false;
+        if (ok) return g;
+    }
 }
 
 constexpr int get_primitive_root(long long mod) {
     if (mod == 998244353) return 3;
-    else find_primitive_root(mod);
+    return find_primitive_root(mod);
 }
 
 template <typename T>
@@ -40,97 +60,624 @@ struct poly_traits< mint<M> > {
     static constexpr int w = get_primitive_root(M);
 };
 
+template <long long M>
+struct poly_traits< mmint<M> > {
+    static constexpr long long mod = M;
+    static constexpr int w = get_primitive_root(M);
+};
+
+template <int id>
+struct poly_traits< dmint<id> > {
+    // mod and w follow dmint<id>::set_mod, the root is searched once per modulus
+    struct mod_t {
+        operator long long() const { return dmint<id>::mod(); }
+    };
+    struct root_t {
+        operator int() const {
+            static long long cached_mod = -1;
+            static int root = -1;
+            if (cached_mod != dmint<id>::mod()) {
+                cached_mod = dmint<id>::mod();
+                root = find_primitive_root(cached_mod);
+            }
+            return root;
+        }
+    };
+    static constexpr mod_t mod{};
+    static constexpr root_t w{};
+};
+
 template <typename T> // forward declaration
 class poly;
+template <typename T>
+class subproduct_tree;
 
 using cpx = std::complex<double>;
 using polycpx = std::vector<cpx>;
 const double PI = acos(-1);
 
+// std::complex operator* goes through the slow NaN-checking path, multiply by hand instead
+inline cpx cmul(const cpx &a, const cpx &b) {
+    return cpx(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+struct fft_table {
+    // rt[k + j] = e^{i pi j / k} for power of two k and j < k, derived in long double so the error does not grow with n
+    static inline std::vector<cpx> rt{cpx(1), cpx(1)};
+    static inline std::vector<std::complex<long double>> rt_ld{1, 1};
+    static inline std::vector<int> rev{0, 1};
+
+    static void reserve(int n) {
+        if ((int)rt.size() >= n) return;
+        int k = rt.size();
+        rt.resize(n); rt_ld.resize(n);
+        for (; k < n; k <<= 1) {
+            auto x = std::polar(1.0L, acosl(-1) / k);
+            for (int i = k; i < 2 * k; i++)
+                rt[i] = rt_ld[i] = (i & 1) ? rt_ld[i / 2] * x : rt_ld[i / 2];
+        }
+        int lg = __builtin_ctz(n);
+        rev.assign(n, 0);
+        for (int i = 1; i < n; i++) rev[i] = (rev[i >> 1] >> 1) | ((i & 1) << (lg - 1));
+    }
+};
+
 void fft(polycpx &a, bool inv = false) {
-    // NOT IMPLEMENTED
+    int n = a.size();
+    assert(n > 0 && (n & -n) == n); // n should be power of 2
+    fft_table::reserve(n);
+    if (inv) std::reverse(a.begin() + 1, a.end());
+    int shift = __builtin_ctz(fft_table::rev.size()) - __builtin_ctz(n);
+    for (int i = 1; i < n; i++) {
+        int j = fft_table::rev[i] >> shift;
+        if (i < j) swap(a[i], a[j]);
+    }
+    const cpx* rt = fft_table::rt.data();
+    for (int k = 1; k < n; k <<= 1)
+        for (int i = 0; i < n; i += 2 * k)
+            for (int j = 0; j < k; j++) {
+                cpx z = cmul(rt[j + k], a[i + j + k]);
+                a[i + j + k] = a[i + j] - z;
+                a[i + j] += z;
+            }
+    if (inv) for (auto &x : a) x /= n;
 }
 
-template <long long mod, int w>
-void ntt(poly<mint<mod>> &a, bool inv = false) {
-    int n = a.size(), j = 0;
-    assert((n & -n) == n); // n should be power of 2
+// real convolution with both inputs packed into one complex transform (2 FFTs)
+// absolute error is roughly max|a| * max|b| * n * log2(n) * 1e-16
+std::vector<double> conv_real(const std::vector<double> &a, const std::vector<double> &b) {
+    if (a.empty() || b.empty()) return {};
+    std::vector<double> res(a.size() + b.size() - 1);
+    int n = 1;
+    while (n < (int)res.size()) n <<= 1;
+    polycpx in(n), out(n);
+    for (int i = 0; i < (int)a.size(); i++) in[i].real(a[i]);
+    for (int i = 0; i < (int)b.size(); i++) in[i].imag(b[i]);
+    fft(in);
+    for (cpx &x : in) x = cmul(x, x);
+    // X = A + iB, so X[-i]^2 - conj(X[i])^2 = 4i (AB)[-i] and a forward transform undoes the reversal
+    for (int i = 0; i < n; i++) out[i] = in[-i & (n - 1)] - conj(in[i]);
+    fft(out);
+    for (int i = 0; i < (int)res.size(); i++) res[i] = imag(out[i]) / (4 * n);
+    return res;
+}
 
-    for(int i = 1; i < n; i++) {
-        int bit = (n >> 1);
-        while(j >= bit) {
-            j -= bit;
-            bit >>= 1;
+// integer convolution by rounding conv_real
+// exact while (sum a_i^2 + sum b_i^2) * log2(n) < 9e14
+std::vector<long long> conv_ll(const std::vector<long long> &a, const std::vector<long long> &b) {
+    std::vector<double> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+    std::vector<double> c = conv_real(fa, fb);
+    std::vector<long long> res(c.size());
+    for (int i = 0; i < (int)c.size(); i++) res[i] = llround(c[i]);
+    return res;
+}
+
+// exact integer convolution for inputs in [0, 2^30), each split into two 15-bit halves (4 FFTs)
+// exact modulo 2^64 for result length a.size() + b.size() - 1 <= 2^19; at 2^20 worst-case inputs
+// (all 2^30 - 1, equal lengths) already round some coefficients wrong
+std::vector<unsigned long long> conv_split(const std::vector<long long> &a, const std::vector<long long> &b) {
+    if (a.empty() || b.empty()) return {};
+    assert(a.size() + b.size() - 1 <= (1u << 19) && "conv_split: result too long to round exactly");
+    std::vector<unsigned long long> res(a.size() + b.size() - 1);
+    int n = 1;
+    while (n < (int)res.size()) n <<= 1;
+    const int cut = 1 << 15;
+    polycpx L(n), R(n), outl(n), outs(n);
+    for (int i = 0; i < (int)a.size(); i++) L[i] = cpx(a[i] / cut, a[i] % cut);
+    for (int i = 0; i < (int)b.size(); i++) R[i] = cpx(b[i] / cut, b[i] % cut);
+    fft(L); fft(R);
+    // separate the hi/lo halves of L by conjugate symmetry and multiply by R in the same pass
+    for (int i = 0; i < n; i++) {
+        int j = -i & (n - 1);
+        outl[j] = cmul(L[i] + conj(L[j]), R[i]) / (2.0 * n);
+        cpx t = cmul(L[i] - conj(L[j]), R[i]) / (2.0 * n);
+        outs[j] = cpx(t.imag(), -t.real()); // t / i
+    }
+    fft(outl); fft(outs);
+    for (int i = 0; i < (int)res.size(); i++) {
+        unsigned long long hi = llround(real(outl[i])), lo = llround(imag(outs[i]));
+        unsigned long long mid = llround(imag(outl[i])) + llround(real(outs[i]));
+        res[i] = (hi << 30) + (mid << 15) + lo;
+    }
+    return res;
+}
+
+template <typename T>
+struct ntt_table {
+    // rt[k + j] = w_{2k}^j for power of two k and j < k, rt3[k + j] = w_{4k}^{3j}, irt/irt3 hold the inverses
+    // rev is the bit reversal of [0, size), all grown lazily and rebuilt on modulus change
+    static inline long long mod = -1;
+    static inline std::vector<T> rt, irt, rt3, irt3;
+    static inline std::vector<int> rev;
+
+    static void reserve(int n) {
+        const long long m = poly_traits<T>::mod;
+        if (mod != m) {
+            mod = m;
+            rt.assign(2, T(1)); irt.assign(2, T(1));
+            rt3.assign(2, T(1)); irt3.assign(2, T(1));
+            rev = {0, 1};
         }
-        j += bit;
-        if(i < j) {
-            swap(a[i], a[j]);
+        if ((int)rt.size() >= n) return;
+        const int w = poly_traits<T>::w;
+        int k = rt.size();
+        rt.resize(n); irt.resize(n);
+        rt3.resize(n / 2); irt3.resize(n / 2);
+        for (; k < n; k <<= 1) {
+            assert((m - 1) % (2 * k) == 0); // 2k-th root of unity must exist
+            T z = T(w).pow((m - 1) / (2 * k)), iz = z.inv();
+            for (int i = k; i < 2 * k; i++) {
+                rt[i] = (i & 1) ? rt[i / 2] * z : rt[i / 2];
+                irt[i] = (i & 1) ? irt[i / 2] * iz : irt[i / 2];
+            }
+            for (int j = 0; j < k / 2; j++) {
+                rt3[k / 2 + j] = rt[k + j] * rt[k / 2 + j];
+                irt3[k / 2 + j] = irt[k + j] * irt[k / 2 + j];
+            }
         }
+        int lg = __builtin_ctz(n);
+        rev.assign(n, 0);
+        for (int i = 1; i < n; i++) rev[i] = (rev[i >> 1] >> 1) | ((i & 1) << (lg - 1));
+    }
+};
+
+// scalar NTT stages on the cached tables, ntt_kernel<T> may override them with SIMD versions
+template <typename T>
+struct ntt_scalar_kernel {
+    using table = ntt_table<T>;
+    static void reserve(int n) { table::reserve(n); }
+
+    // radix-2 DIF stage over blocks of length 2h
+    static void dif2(T* a, int n, int h) {
+        const T* rt = table::rt.data();
+        for (int s = 0; s < n; s += 2 * h)
+            for (int j = 0; j < h; j++) {
+                T u = a[s + j], v = a[s + j + h];
+                a[s + j] = u + v;
+                a[s + j + h] = (u - v) * rt[h + j];
+            }
+    }
+    // radix-4 DIF stage over blocks of length 4q
+    static void dif4(T* a, int n, int q) {
+        const T* rt = table::rt.data();
+        const T* rt3 = table::rt3.data();
+        const T imag = rt[3];
+        for (int s = 0; s < n; s += 4 * q) {
+            T* p = a + s;
+            for (int k = 0; k < q; k++) {
+                T a0 = p[k], a1 = p[k + q], a2 = p[k + 2 * q], a3 = p[k + 3 * q];
+                T b0 = a0 + a2, b1 = a1 + a3;
+                T t0 = a0 - a2, t1 = (a1 - a3) * imag;
+                p[k] = b0 + b1;
+                p[k + q] = (b0 - b1) * rt[q + k];
+                p[k + 2 * q] = (t0 + t1) * rt[2 * q + k];
+                p[k + 3 * q] = (t0 - t1) * rt3[q + k];
+            }
+        }
+    }
+    static void dit2(T* a, int n, int h) {
+        const T* irt = table::irt.data();
+        for (int s = 0; s < n; s += 2 * h)
+            for (int j = 0; j < h; j++) {
+                T u = a[s + j], v = a[s + j + h] * irt[h + j];
+                a[s + j] = u + v;
+                a[s + j + h] = u - v;
+            }
+    }
+    static void dit4(T* a, int n, int q) {
+        const T* irt = table::irt.data();
+        const T* irt3 = table::irt3.data();
+        const T iimag = irt[3];
+        for (int s = 0; s < n; s += 4 * q) {
+            T* p = a + s;
+            for (int k = 0; k < q; k++) {
+                T c0 = p[k];
+                T t1 = p[k + q] * irt[q + k];
+                T t2 = p[k + 2 * q] * irt[2 * q + k];
+                T t3 = p[k + 3 * q] * irt3[q + k];
+                T b0 = c0 + t1, b1 = c0 - t1;
+                T x = t2 + t3, y = (t2 - t3) * iimag;
+                p[k] = b0 + x;
+                p[k + q] = b1 + y;
+                p[k + 2 * q] = b0 - x;
+                p[k + 3 * q] = b1 - y;
+            }
+        }
+    }
+    static void scale(T* a, int n, T c) {
+        for (int i = 0; i < n; i++) a[i] *= c;
+    }
+    static void pointwise(T* a, const T* b, int n) {
+        for (int i = 0; i < n; i++) a[i] *= b[i];
+    }
+};
+
+template <typename T>
+struct ntt_kernel : ntt_scalar_kernel<T> {};
+
+#ifdef __AVX2__
+// Montgomery butterflies on the uint32_t storage of mint<mod>, 8 lanes per vector (build with -mavx2)
+// twiddles are kept in Montgomery form, so mont(a * wR) = a * w stays in normal form
+template <long long mod>
+struct ntt_kernel< mint<mod> > : ntt_scalar_kernel< mint<mod> > {
+    using T = mint<mod>;
+    using base = ntt_scalar_kernel<T>;
+    using table = ntt_table<T>;
+    using u32 = unsigned int;
+    using u64 = unsigned long long;
+    static_assert(sizeof(T) == sizeof(u32));
+    static constexpr bool enabled = mod % 2 == 1 && mod < (1LL << 30);
+
+    static constexpr u32 get_pinv() {
+        u32 r = mod;
+        for (int i = 0; i < 4; i++) r *= 2 - (u32)mod * r;
+        return r;
+    }
+    static constexpr u32 pinv = get_pinv();                 // mod^{-1} mod 2^32
+    static constexpr u32 r2 = -(u64)mod % mod;             // 2^64 mod mod
+    static u32 to_mont(T x) { return ((u64)x.val() << 32) % mod; }
+
+    static inline std::vector<u32> mrt, mirt, mrt3, mirt3;
+    static void reserve(int n) {
+        table::reserve(n);
+        if (!enabled || mrt.size() == table::rt.size()) return;
+        auto conv_table = [](std::vector<u32>& dst, const std::vector<T>& src) {
+            dst.resize(src.size());
+            for (size_t i = 0; i < src.size(); i++) dst[i] = to_mont(src[i]);
+        };
+        conv_table(mrt, table::rt); conv_table(mirt, table::irt);
+        conv_table(mrt3, table::rt3); conv_table(mirt3, table::irt3);
     }
 
-    vector<mint<mod>> roots(n/2);
-    mint<mod> t = ((mint<mod>)(w)).pow((mod - 1) / n);
-    if(inv) t = t.pow(mod - 2);
-    for(int i = 0; i < n/2; i++) {
-        if(i == 0) roots[i] = 1;
-        else roots[i] = roots[i-1]*t;
+    static __m256i vp() { return _mm256_set1_epi32(mod); }
+    static __m256i add(__m256i a, __m256i b) {
+        __m256i s = _mm256_add_epi32(a, b);
+        return _mm256_min_epu32(s, _mm256_sub_epi32(s, vp()));
+    }
+    static __m256i sub(__m256i a, __m256i b) {
+        __m256i d = _mm256_sub_epi32(a, b);
+        return _mm256_min_epu32(d, _mm256_add_epi32(d, vp()));
     }
+    // a * b * 2^{-32} mod p, inputs and output in [0, p)
+    static __m256i mul(__m256i a, __m256i b) {
+        const __m256i P = vp(), PINV = _mm256_set1_epi32(pinv);
+        __m256i xe = _mm256_mul_epu32(a, b);
+        __m256i xo = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        __m256i me = _mm256_mul_epu32(_mm256_mul_epu32(xe, PINV), P);
+        __m256i mo = _mm256_mul_epu32(_mm256_mul_epu32(xo, PINV), P);
+        __m256i xhi = _mm256_blend_epi32(_mm256_srli_epi64(xe, 32), xo, 0b10101010);
+        __m256i mhi = _mm256_blend_epi32(_mm256_srli_epi64(me, 32), mo, 0b10101010);
+        return sub(xhi, mhi);
+    }
+    static __m256i load(const void* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void store(void* p, __m256i x) { _mm256_storeu_si256((__m256i*)p, x); }
 
-    for(int i = 2; i <= n; i <<= 1) {
-        int step = n/i;
-        for(int j = 0; j < n; j+=i) 
-            for(int k = 0; k < i/2; k++) {
-                mint<mod> u = a[j + k];
-                mint<mod> v = a[j + k + i/2] * roots[step * k];
-                a[j + k] = u + v;
-                a[j + k + i/2] = u - v;
+    static void dif2(T* a, int n, int h) {
+        if (!enabled || h < 8) return base::dif2(a, n, h);
+        u32* p = (u32*)a;
+        for (int s = 0; s < n; s += 2 * h)
+            for (int j = 0; j < h; j += 8) {
+                __m256i u = load(p + s + j), v = load(p + s + j + h);
+                store(p + s + j, add(u, v));
+                store(p + s + j + h, mul(sub(u, v), load(&mrt[h + j])));
+            }
+    }
+    static void dif4(T* a, int n, int q) {
+        if (!enabled || q < 8) return base::dif4(a, n, q);
+        const __m256i imag = _mm256_set1_epi32(mrt[3]);
+        for (int s = 0; s < n; s += 4 * q) {
+            u32* p = (u32*)(a + s);
+            for (int k = 0; k < q; k += 8) {
+                __m256i a0 = load(p + k), a1 = load(p + k + q), a2 = load(p + k + 2 * q), a3 = load(p + k + 3 * q);
+                __m256i b0 = add(a0, a2), b1 = add(a1, a3);
+                __m256i t0 = sub(a0, a2), t1 = mul(sub(a1, a3), imag);
+                store(p + k, add(b0, b1));
+                store(p + k + q, mul(sub(b0, b1), load(&mrt[q + k])));
+                store(p + k + 2 * q, mul(add(t0, t1), load(&mrt[2 * q + k])));
+                store(p + k + 3 * q, mul(sub(t0, t1), load(&mrt3[q + k])));
+            }
+        }
+    }
+    static void dit2(T* a, int n, int h) {
+        if (!enabled || h < 8) return base::dit2(a, n, h);
+        u32* p = (u32*)a;
+        for (int s = 0; s < n; s += 2 * h)
+            for (int j = 0; j < h; j += 8) {
+                __m256i u = load(p + s + j), v = mul(load(p + s + j + h), load(&mirt[h + j]));
+                store(p + s + j, add(u, v));
+                store(p + s + j + h, sub(u, v));
             }
     }
-    mint<mod> inv_n = mint<mod>(n).inv();
-    if(inv) for(int i = 0; i < n; i++) a[i] *= inv_n;
+    static void dit4(T* a, int n, int q) {
+        if (!enabled || q < 8) return base::dit4(a, n, q);
+        const __m256i iimag = _mm256_set1_epi32(mirt[3]);
+        for (int s = 0; s < n; s += 4 * q) {
+            u32* p = (u32*)(a + s);
+            for (int k = 0; k < q; k += 8) {
+                __m256i c0 = load(p + k);
+                __m256i t1 = mul(load(p + k + q), load(&mirt[q + k]));
+                __m256i t2 = mul(load(p + k + 2 * q), load(&mirt[2 * q + k]));
+                __m256i t3 = mul(load(p + k + 3 * q), load(&mirt3[q + k]));
+                __m256i b0 = add(c0, t1), b1 = sub(c0, t1);
+                __m256i x = add(t2, t3), y = mul(sub(t2, t3), iimag);
+                store(p + k, add(b0, x));
+                store(p + k + q, add(b1, y));
+                store(p + k + 2 * q, sub(b0, x));
+                store(p + k + 3 * q, sub(b1, y));
+            }
+        }
+    }
+    static void scale(T* a, int n, T c) {
+        if (!enabled || n < 8) return base::scale(a, n, c);
+        u32* p = (u32*)a;
+        const __m256i mc = _mm256_set1_epi32(to_mont(c));
+        for (int i = 0; i < n; i += 8) store(p + i, mul(load(p + i), mc));
+    }
+    // mont(mont(a * b) * 2^64) = a * b
+    static void pointwise(T* a, const T* b, int n) {
+        if (!enabled) return base::pointwise(a, b, n);
+        u32* p = (u32*)a;
+        const u32* q = (const u32*)b;
+        const __m256i R2 = _mm256_set1_epi32(r2);
+        int i = 0;
+        for (; i + 8 <= n; i += 8) store(p + i, mul(mul(load(p + i), load(q + i)), R2));
+        for (; i < n; i++) a[i] *= b[i];
+    }
+};
+#endif
+
+// forward transform, natural order in, bit-reversed order out
+template <typename T>
+void ntt_dif(T* a, int n) {
+    assert(n > 0 && (n & -n) == n);
+    using kernel = ntt_kernel<T>;
+    kernel::reserve(n);
+    int len = n;
+    if (__builtin_ctz(n) & 1) {
+        kernel::dif2(a, n, n / 2);
+        len = n / 2;
+    }
+    for (; len >= 4; len >>= 2) kernel::dif4(a, n, len / 4);
 }
 
-template <long long mod, int w>
-poly<mint<mod>> conv(const poly<mint<mod>> &A, const poly<mint<mod>> &B) {
-    if(A.size() == 0 || B.size() == 0)
-        return poly<mint<mod>>();
-    
-    if (std::min(A.size(), B.size()) <= 60) {
-        poly<mint<mod>> C;
-        C.resize(A.size() + B.size() - 1);
-        for (int i = 0; i < A.size(); i++) {
-            for (int j = 0; j < B.size(); j++) {
-                C[i + j] += A[i] * B[j];
-            }
+// inverse transform (scaled by 1/n), bit-reversed order in, natural order out
+template <typename T>
+void ntt_dit(T* a, int n) {
+    assert(n > 0 && (n & -n) == n);
+    using kernel = ntt_kernel<T>;
+    kernel::reserve(n);
+    for (int len = 4; len <= n; len <<= 2) kernel::dit4(a, n, len / 4);
+    if (__builtin_ctz(n) & 1) kernel::dit2(a, n, n / 2);
+    kernel::scale(a, n, T(n).inv());
+}
+
+// grow the tables up to length n ahead of time, needed before transforming from several threads
+template <typename T>
+void ntt_reserve(int n) { ntt_kernel<T>::reserve(n); }
+
+// a[i] *= b[i] on transformed buffers
+template <typename T>
+void ntt_pointwise(T* a, const T* b, int n) { ntt_kernel<T>::pointwise(a, b, n); }
+
+// natural order transform
+template <typename T>
+void ntt(poly<T> &a, bool inv = false) {
+    int n = a.size();
+    assert(n > 0 && (n & -n) == n); // n should be power of 2
+    using table = ntt_table<T>;
+    table::reserve(n);
+    T* p = &a[0];
+    auto bit_reverse = [&]() {
+        int shift = __builtin_ctz(table::rev.size()) - __builtin_ctz(n);
+        for(int i = 1; i < n; i++) {
+            int j = table::rev[i] >> shift;
+            if(i < j) swap(p[i], p[j]);
         }
-        return C;
+    };
+    if(!inv) { ntt_dif(p, n); bit_reverse(); }
+    else { bit_reverse(); ntt_dit(p, n); }
+}
+
+// square root of a modulo the prime modulus of T (Tonelli-Shanks), false if a is not a quadratic residue
+template <typename T>
+bool mod_sqrt(const T& a, T& res) {
+    const long long p = poly_traits<T>::mod;
+    if (a == T(0) || p == 2) { res = a; return true; }
+    if (a.pow((p - 1) / 2) != T(1)) return false;
+    long long q = p - 1;
+    int s = 0;
+    while (q % 2 == 0) q /= 2, s++;
+    T z = T(2);
+    while (z.pow((p - 1) / 2) == T(1)) z += T(1);
+    T c = z.pow(q), x = a.pow((q + 1) / 2), t = a.pow(q);
+    while (t != T(1)) {
+        int i = 0;
+        for (T u = t; u != T(1); u *= u) i++;
+        T b = c;
+        for (int j = 0; j < s - i - 1; j++) b *= b;
+        x *= b;
+        c = b * b;
+        t *= c;
+        s = i;
     }
-    
-    poly<mint<mod>> nA = A;
-    poly<mint<mod>> nB = B;
-    int conv_deg = A.deg() + B.deg();
+    res = x;
+    return true;
+}
+
+// largest power of two transform length supported by the modulus of T
+template <typename T>
+long long ntt_max_size() {
+    const long long mod = poly_traits<T>::mod;
+    return (mod - 1) & -(mod - 1);
+}
+
+// thread-local bump allocator for transform scratch space. A scope hands back everything allocated inside it on
+// exit, blocks are kept, so once the largest working set has been seen nothing touches the heap anymore
+template <typename T>
+class poly_arena {
+private:
+    struct block {
+        std::unique_ptr<T[]> data;
+        size_t size;
+    };
+    static inline thread_local std::vector<block> blocks;
+    static inline thread_local size_t cur = 0, top = 0;
+    static inline std::atomic<long long> heap_allocs{0};
+
+public:
+    class scope {
+    private:
+        size_t c, t;
+    public:
+        scope() : c(cur), t(top) {}
+        ~scope() { cur = c; top = t; }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+    };
+    // n uninitialized elements, valid until the innermost enclosing scope ends
+    static T* alloc(size_t n) {
+        while (cur < blocks.size() && top + n > blocks[cur].size) cur++, top = 0;
+        if (cur == blocks.size()) {
+            size_t sz = std::max<size_t>(n, blocks.empty() ? 1 << 16 : 2 * blocks.back().size);
+            blocks.push_back({std::unique_ptr<T[]>(new T[sz]), sz});
+            heap_allocs++;
+            top = 0;
+        }
+        T* res = blocks[cur].data.get() + top;
+        top += n;
+        return res;
+    }
+    // heap blocks taken by the arena over all threads
+    static long long allocations() { return heap_allocs; }
+};
+
+template <typename T>
+poly<T> conv_crt(const poly<T> &A, const poly<T> &B);
+
+// c[0, na + nb - 1) = a * b, c must not overlap a or b
+template <typename T>
+void conv_raw(const T* a, int na, const T* b, int nb, T* c) {
+    if (std::min(na, nb) <= 60) {
+        std::fill(c, c + na + nb - 1, T(0));
+        for (int i = 0; i < na; i++)
+            for (int j = 0; j < nb; j++)
+                c[i + j] += a[i] * b[j];
+        return;
+    }
+    int conv_deg = na + nb - 2;
     int m = 1;
     while(m <= conv_deg) m <<= 1;
+    if(m > ntt_max_size<T>()) {
+        poly<T> C = conv_crt(poly<T>(std::vector<T>(a, a + na)), poly<T>(std::vector<T>(b, b + nb)));
+        C.resize(conv_deg + 1);
+        std::copy(C.begin(), C.end(), c);
+        return;
+    }
 
-    nA.resize(m); 
-    nB.resize(m);
-    ntt<mod,w>(nA); 
-    ntt<mod,w>(nB);
-    for(int i = 0; i < m; i++) nA[i] *= nB[i];
-    ntt<mod,w>(nA, true);
-    nA.resize(conv_deg + 1);
+    typename poly_arena<T>::scope scope;
+    bool square = a == b && na == nb;
+    T* x = poly_arena<T>::alloc(m);
+    T* y = square ? x : poly_arena<T>::alloc(m);
+    std::copy(a, a + na, x);
+    std::fill(x + na, x + m, T(0));
+    ntt_dif(x, m);
+    if (!square) {
+        std::copy(b, b + nb, y);
+        std::fill(y + nb, y + m, T(0));
+        ntt_dif(y, m);
+    }
+    ntt_pointwise(x, y, m);
+    ntt_dit(x, m);
+    std::copy(x, x + conv_deg + 1, c);
+}
 
-    return nA;
+// middle product c[k] = sum_j a[k + j] b[j] for k < nc, a holds nc + nb - 1 entries, c must not overlap a or b
+template <typename T>
+void middle_product_raw(const T* a, const T* b, int nb, T* c, int nc) {
+    int na = nc + nb - 1;
+    if (std::min(nb, nc) <= 32) {
+        for (int k = 0; k < nc; k++) {
+            T s = T(0);
+            for (int j = 0; j < nb; j++) s += a[k + j] * b[j];
+            c[k] = s;
+        }
+        return;
+    }
+    int m = 1;
+    while (m < na) m <<= 1;
+    if (m > ntt_max_size<T>()) {
+        std::vector<T> rb(b, b + nb), p(na + nb - 1);
+        std::reverse(rb.begin(), rb.end());
+        conv_raw(a, na, rb.data(), nb, p.data());
+        std::copy(p.begin() + nb - 1, p.begin() + na, c);
+        return;
+    }
+    // the cyclic product of a and reversed b of length >= na only wraps below index nb - 1
+    typename poly_arena<T>::scope scope;
+    T* x = poly_arena<T>::alloc(m);
+    T* y = poly_arena<T>::alloc(m);
+    std::copy(a, a + na, x);
+    std::fill(x + na, x + m, T(0));
+    std::reverse_copy(b, b + nb, y);
+    std::fill(y + nb, y + m, T(0));
+    ntt_dif(x, m);
+    ntt_dif(y, m);
+    ntt_pointwise(x, y, m);
+    ntt_dit(x, m);
+    std::copy(x + nb - 1, x + na, c);
 }
 
+// C = A * B reusing the storage of C, which may be A or B
+template <typename T>
+void conv_into(const poly<T> &A, const poly<T> &B, poly<T> &C) {
+    if(A.size() == 0 || B.size() == 0) {
+        C.clear();
+        return;
+    }
+    int len = A.size() + B.size() - 1;
+    if (&C == &A || &C == &B) {
+        typename poly_arena<T>::scope scope;
+        T* c = poly_arena<T>::alloc(len);
+        conv_raw(A.data(), A.size(), B.data(), B.size(), c);
+        C.resize(len);
+        std::copy(c, c + len, C.data());
+        return;
+    }
+    C.resize(len);
+    conv_raw(A.data(), A.size(), B.data(), B.size(), C.data());
+}
 
+template <typename T>
+poly<T> conv(const poly<T> &A, const poly<T> &B) {
+    poly<T> C;
+    conv_into(A, B, C);
+    return C;
+}
 
 template <typename T>
 class poly {
 private:
     std::vector<T> V;
-    static constexpr long long mod = poly_traits<T>::mod;
-    static constexpr int w = poly_traits<T>::w;
     
 public:
     poly() {}
@@ -150,6 +697,8 @@ public:
         while (!V.empty() && V.back() == T(0)) V.pop_back();
         return *this;
     }
+    T* data() { return V.data(); }
+    const T* data() const { return V.data(); }
     auto begin() { return V.begin(); }
     auto end() { return V.end(); }
     auto begin() const { return V.begin(); }
@@ -208,7 +757,7 @@ public:
         for(int i = 0; i < rhs.size(); i++) V[i] -= rhs[i];
         return truncate();
     }
-    poly& operator*=(const poly<T>& rhs) { return *this = conv<mod, w>(*this, rhs); }
+    poly& operator*=(const poly<T>& rhs) { conv_into(*this, rhs, *this); return *this; }
     poly& operator/=(const poly<T>& rhs) {
         poly<T> rhs_inv = rhs.inv(size());
         return *this *= rhs_inv;
@@ -262,38 +811,213 @@ public:
         if (empty()) return poly();
         std::vector<T> res(size() + 1);
         res[0] = T(0);
+        comb<T>::reserve(size());
         for (int i = 0; i < size(); ++i) 
-            res[i + 1] = V[i] / T(i + 1);
+            res[i + 1] = V[i] * comb<T>::_inv[i + 1];
         return poly(std::move(res));
     }
-    poly inv(int t) const {
+    using arena = poly_arena<T>;
+    static int ceil_pow2(int t) {
+        int n = 1;
+        while (n < t) n <<= 1;
+        return n;
+    }
+    // g[0, m) holds f^{-1} mod x^m for the series f[0, fn), extend it to g[0, 2m) with 5 transforms of length 2m
+    static void inv_step(const T* f, int fn, T* g, int m) {
+        typename arena::scope scope;
+        T* a = arena::alloc(2 * m);
+        T* b = arena::alloc(2 * m);
+        int k = std::min(fn, 2 * m);
+        std::copy(f, f + k, a);
+        std::fill(a + k, a + 2 * m, T(0));
+        std::copy(g, g + m, b);
+        std::fill(b + m, b + 2 * m, T(0));
+        ntt_dif(a, 2 * m);
+        ntt_dif(b, 2 * m);
+        ntt_pointwise(a, b, 2 * m);
+        ntt_dit(a, 2 * m);
+        // f g = 1 + x^m h (mod x^{2m}), the cyclic wrap only lands on the low half
+        std::fill(a, a + m, T(0));
+        ntt_dif(a, 2 * m);
+        ntt_pointwise(a, b, 2 * m);
+        ntt_dit(a, 2 * m);
+        for (int i = m; i < 2 * m; i++) g[i] = -a[i];
+    }
+    // g = f^{-1} mod x^t, g has room for ceil_pow2(t) entries
+    static void inv_raw(const T* f, int fn, T* g, int t) {
+        g[0] = T(1) / f[0];
+        for (int m = 1; m < t; m <<= 1) inv_step(f, fn, g, m);
+    }
+    static bool ntt_newton(int t) { return 2 * ceil_pow2(t) <= ntt_max_size<T>(); }
+
+    // out = f^{-1} mod x^t, reusing the storage of out
+    void inv_into(int t, poly& out) const {
         assert(V[0] != T(0));
-        poly<T> f = *this % t, g = poly<T>(1 / V[0]);
-        int k;
-        for(int i = 2; i <= 2 * t; i <<= 1) {
-            k = i;
-            if(k > t) [[unlikely]] k = t;
-            g = g * (- (g * (f % k) % k) + T(2)) % k;
-        }
-        g %= t;
-        return g;
+        if (!ntt_newton(t)) {
+            poly<T> f = *this % t, g = poly<T>(1 / V[0]);
+            int k;
+            for(int i = 2; i <= 2 * t; i <<= 1) {
+                k = i;
+                if(k > t) [[unlikely]] k = t;
+                g = g * (- (g * (f % k) % k) + T(2)) % k;
+            }
+            g %= t;
+            out = std::move(g);
+            return;
+        }
+        if (&out == this) {
+            typename arena::scope scope;
+            T* g = arena::alloc(ceil_pow2(t));
+            inv_raw(V.data(), size(), g, t);
+            out.V.assign(g, g + t);
+            return;
+        }
+        out.V.resize(ceil_pow2(t));
+        inv_raw(V.data(), size(), out.V.data(), t);
+        out.V.resize(t);
+    }
+    poly inv(int t) const {
+        poly<T> res;
+        inv_into(t, res);
+        return res;
     }
     poly log(int t) const {
-        poly<T> f = *this;
-        return (f.derivate() * f.inv(t)).integrate() % t;
+        if (t == 0) return poly();
+        if (!ntt_newton(t)) {
+            poly<T> d = derivate() % (t - 1);
+            return (d * inv(t - 1) % (t - 1)).integrate() % t;
+        }
+        poly<T> res(t);
+        if (t == 1) return res;
+        // f' / f mod x^{t-1}, integrated
+        typename arena::scope scope;
+        T* d = arena::alloc(t - 1);
+        T* g = arena::alloc(ceil_pow2(t - 1));
+        T* c = arena::alloc(2 * t - 3);
+        for (int i = 0; i + 1 < t; i++) d[i] = i + 1 < size() ? V[i + 1] * T(i + 1) : T(0);
+        inv_raw(V.data(), size(), g, t - 1);
+        conv_raw(d, t - 1, g, t - 1, c);
+        comb<T>::reserve(t);
+        for (int i = 1; i < t; i++) res[i] = c[i - 1] * comb<T>::_inv[i];
+        return res;
     }
+    // Newton on b <- b (1 + f - log b), keeping b^{-1} and the transforms of b and b^{-1} between steps
     poly exp(int t) {
         assert(V[0] == T(0));
-        poly<T> g = singleton(0);
-        poly<T> f = *this % t;
-        int k;
-        for(int i = 2; i <= 2 * t; i <<= 1) {
-            k = i;
-            if(k > t) [[unlikely]] k = t;
-            g = g * ((f % k) + T(1) - (g.log(k))) % k;
-        }
-        g %= t;
-        return g;
+        if (!ntt_newton(t)) {
+            poly<T> g = singleton(0);
+            poly<T> f = *this % t;
+            int k;
+            for(int i = 2; i <= 2 * t; i <<= 1) {
+                k = i;
+                if(k > t) [[unlikely]] k = t;
+                g = g * ((f % k) + T(1) - (g.log(k))) % k;
+            }
+            g %= t;
+            return g;
+        }
+        auto f = [&](int i) { return i < size() ? V[i] : T(0); };
+        typename arena::scope scope;
+        const int n = std::max(2, ceil_pow2(t));
+        T *b = arena::alloc(n), *c = arena::alloc(n), *y = arena::alloc(n), *z = arena::alloc(n);
+        T *x = arena::alloc(n), *z1 = arena::alloc(n), *z2 = arena::alloc(n);
+        comb<T>::reserve(n);
+        // b = exp(f) mod x^m, c = b^{-1} mod x^{m/2}, z2 = transform of c at length m
+        b[0] = T(1), b[1] = f(1);
+        c[0] = T(1);
+        z2[0] = z2[1] = T(1);
+        for (int m = 2; m < t; m <<= 1) {
+            std::copy(b, b + m, y);
+            std::fill(y + m, y + 2 * m, T(0));
+            ntt_dif(y, 2 * m); // its first half is the length m transform of b
+
+            // c <- b^{-1} mod x^m
+            std::swap(z1, z2);
+            std::copy(y, y + m, z);
+            ntt_pointwise(z, z1, m);
+            ntt_dit(z, m);
+            std::fill(z, z + m / 2, T(0));
+            ntt_dif(z, m);
+            ntt_pointwise(z, z1, m);
+            ntt_dit(z, m);
+            for (int i = m / 2; i < m; i++) c[i] = -z[i];
+            std::copy(c, c + m, z2);
+            std::fill(z2 + m, z2 + 2 * m, T(0));
+            ntt_dif(z2, 2 * m);
+
+            // r = f' b - b' vanishes below x^{m-1}, so its length m cyclic product holds r[m-1, 2m-1)
+            for (int i = 0; i + 1 < m; i++) x[i] = f(i + 1) * T(i + 1);
+            x[m - 1] = T(0);
+            ntt_dif(x, m);
+            ntt_pointwise(x, y, m);
+            ntt_dit(x, m);
+            for (int i = 0; i + 1 < m; i++) x[i] -= b[i + 1] * T(i + 1);
+            for (int i = 0; i + 1 < m; i++) x[m + i] = x[i], x[i] = T(0);
+            x[2 * m - 1] = T(0);
+
+            // f - log b = integral of r / b, then b <- b + b (f - log b)
+            ntt_dif(x, 2 * m);
+            ntt_pointwise(x, z2, 2 * m);
+            ntt_dit(x, 2 * m);
+            for (int i = 2 * m - 1; i >= m; i--) x[i] = x[i - 1] * comb<T>::_inv[i] + f(i);
+            std::fill(x, x + m, T(0));
+            ntt_dif(x, 2 * m);
+            ntt_pointwise(x, y, 2 * m);
+            ntt_dit(x, 2 * m);
+            std::copy(x + m, x + 2 * m, b + m);
+        }
+        poly<T> res(t);
+        std::copy(b, b + t, res.V.begin());
+        return res;
+    }
+    // square root for f[0] = 1, g <- g + (f - g^2) / 2g with g^{-1} extended one Newton step per iteration
+    poly sqrt_unit(int t) const {
+        assert(!empty() && V[0] == T(1));
+        const T inv2 = T(2).inv();
+        if (!ntt_newton(t)) {
+            poly<T> g = singleton(0);
+            for (int k = 2; k < 2 * t; k <<= 1)
+                g = (g + (*this % k) * g.inv(k) % k) * inv2;
+            g %= t;
+            return g;
+        }
+        typename arena::scope scope;
+        const int n = ceil_pow2(t);
+        T *g = arena::alloc(n), *h = arena::alloc(n), *a = arena::alloc(n), *d = arena::alloc(n), *e = arena::alloc(n);
+        g[0] = h[0] = T(1);
+        for (int m = 1; m < t; m <<= 1) {
+            if (m > 1) inv_step(g, m, h, m / 2); // h = g^{-1} mod x^m
+            std::copy(g, g + m, a);
+            std::fill(a + m, a + 2 * m, T(0));
+            ntt_dif(a, 2 * m);
+            ntt_pointwise(a, a, 2 * m);
+            ntt_dit(a, 2 * m);
+            for (int i = 0; i < m; i++) d[i] = (m + i < size() ? V[m + i] : T(0)) - a[m + i];
+            std::fill(d + m, d + 2 * m, T(0));
+            std::copy(h, h + m, e);
+            std::fill(e + m, e + 2 * m, T(0));
+            ntt_dif(d, 2 * m);
+            ntt_dif(e, 2 * m);
+            ntt_pointwise(d, e, 2 * m);
+            ntt_dit(d, 2 * m);
+            for (int i = 0; i < m; i++) g[m + i] = d[i] * inv2;
+        }
+        poly<T> res(t);
+        std::copy(g, g + t, res.V.begin());
+        return res;
+    }
+
+    // some g with g^2 = f mod x^t, or an empty poly when there is none
+    poly sqrt(int t) const {
+        int z = 0;
+        while (z < size() && V[z] == T(0)) z++;
+        if (z == size() || z >= t) return poly<T>(t); // f = 0 mod x^t
+        T c;
+        if (z % 2 == 1 || !mod_sqrt(V[z], c)) return poly();
+        poly<T> h = (*this >> z) / V[z];
+        poly<T> res = h.sqrt_unit(t - z / 2) * c;
+        res <<= z / 2;
+        return res;
     }
 
     poly pow(long long k, int t) {
@@ -332,48 +1056,165 @@ public:
         return {q.truncate(), r.truncate()};
     }
 
-    poly remainder(const poly& g) const {
+    // r = f mod g, reusing the storage of r, which may be f or g
+    void remainder_into(const poly& g, poly& r) const {
         assert(!g.empty());
-        poly f = *this;
-        if(f.deg() < g.deg()) return f; 
-
-        if(g.deg() <= 32 || f.deg() - g.deg() <= 32) {
-            poly r = f;
-            int fd = f.deg(), gd = g.deg();
-            T g_inv = T(1) / g[gd];
-            
-            for(int i = fd; i >= gd; i--) {
-                T coef = r[i] * g_inv;
-                for(int j = 0; j <= gd; j++) {
-                    r[i - gd + j] -= coef * g[j];
+        int n = size(), d = g.deg();
+        if(n - 1 < d) {
+            if (&r != this) r.V.assign(V.begin(), V.end());
+            return;
+        }
+        typename arena::scope scope;
+        T* w = arena::alloc(d);
+        int k = n - d; // quotient length
+
+        if(d <= 32 || k <= 32) {
+            T* f = arena::alloc(n);
+            std::copy(V.begin(), V.end(), f);
+            T g_inv = T(1) / g.V[d];
+            for(int i = n - 1; i >= d; i--) {
+                T coef = f[i] * g_inv;
+                for(int j = 0; j <= d; j++) {
+                    f[i - d + j] -= coef * g.V[j];
                 }
             }
-            r.V.resize(gd);
-            return r.truncate();
+            std::copy(f, f + d, w);
+        } else if (!ntt_newton(k) || ceil_pow2(d) > ntt_max_size<T>()) {
+            poly<T> rem = divide_and_remainder(g).second;
+            rem.resize(d);
+            std::copy(rem.begin(), rem.end(), w);
+        } else {
+            // reversed quotient = rev(f) / rev(g) mod x^k
+            T* fr = arena::alloc(k);
+            T* gr = arena::alloc(k);
+            T* gi = arena::alloc(ceil_pow2(k));
+            T* qr = arena::alloc(2 * k - 1);
+            for (int i = 0; i < k; i++) fr[i] = V[n - 1 - i], gr[i] = i <= d ? g.V[d - i] : T(0);
+            inv_raw(gr, k, gi, k);
+            conv_raw(fr, k, gi, k, qr);
+            // f - q g has degree < d, so it survives reduction mod x^L - 1 for L >= d
+            int L = ceil_pow2(d);
+            T* q = arena::alloc(L);
+            T* gf = arena::alloc(L);
+            std::fill(q, q + L, T(0));
+            std::fill(gf, gf + L, T(0));
+            std::fill(w, w + d, T(0));
+            for (int i = 0; i < k; i++) q[i & (L - 1)] += qr[k - 1 - i];
+            for (int i = 0; i <= d; i++) gf[i & (L - 1)] += g.V[i];
+            ntt_dif(q, L);
+            ntt_dif(gf, L);
+            ntt_pointwise(q, gf, L);
+            ntt_dit(q, L);
+            for (int i = 0; i < n; i++) {
+                int j = i & (L - 1);
+                if (j < d) w[j] += V[i];
+            }
+            for (int i = 0; i < d; i++) w[i] -= q[i];
         }
-
-        return f.divide_and_remainder(g).second;
+        r.V.assign(w, w + d);
+        r.truncate();
+    }
+    poly remainder(const poly& g) const {
+        poly<T> r;
+        remainder_into(g, r);
+        return r;
     }
 
-    poly taylor_shift(T c) const {
+    // f(x + c) for every c in cs: g_k = (1 / k!) sum_i f_i i! c^{i-k} / (i-k)!, the reversed f_i i! is transformed once
+    std::vector<poly> taylor_shift_many(const std::vector<T>& cs) const {
         int sz = size();
-        T fac = T(1);
-        poly A = *this;
-        poly C = poly().resize(sz);
-        for(int i = 0; i < sz; i++) {
-            A[i] *= fac;
-            C[i] = c.pow(i) / fac;
-            fac *= T(i + 1);
-        }
-        poly B = C * A.reverse();
-        B %= sz;
-        B = B.reverse();
-        fac = T(1);
-        poly res = poly().resize(sz);
-        for(int i = 0; i < sz; i++) {
-            res[i] = B[i] / fac;
-            fac *= T(i + 1);
+        std::vector<poly> res(cs.size(), poly<T>(sz));
+        if (sz == 0) return res;
+        comb<T>::reserve(sz);
+        const std::vector<T> &fac = comb<T>::_fac, &ifac = comb<T>::_ifac;
+        typename arena::scope scope;
+        int L = ceil_pow2(2 * sz - 1);
+        bool ntt = L <= ntt_max_size<T>();
+        T* a = arena::alloc(ntt ? L : sz);
+        T* e = arena::alloc(ntt ? L : sz);
+        T* b = arena::alloc(ntt ? L : 2 * sz - 1);
+        for (int j = 0; j < sz; j++) a[j] = V[sz - 1 - j] * fac[sz - 1 - j];
+        if (ntt) {
+            std::fill(a + sz, a + L, T(0));
+            ntt_dif(a, L);
         }
+        for (int s = 0; s < (int)cs.size(); s++) {
+            T p = T(1);
+            for (int i = 0; i < sz; i++, p *= cs[s]) e[i] = p * ifac[i];
+            if (ntt) {
+                std::fill(e + sz, e + L, T(0));
+                ntt_dif(e, L);
+                ntt_pointwise(e, a, L);
+                ntt_dit(e, L);
+                std::copy(e, e + sz, b);
+            } else {
+                conv_raw(a, sz, e, sz, b);
+            }
+            for (int k = 0; k < sz; k++) res[s].V[k] = b[sz - 1 - k] * ifac[k];
+        }
+        return res;
+    }
+    poly taylor_shift(T c) const { return taylor_shift_many({c})[0]; }
+
+    // f(g) mod x^n (Kinoshita-Li) as the transpose of power projection w -> (sum_j w_j [x^j] g^i)_i, which is
+    // [x^{n-1}] rev(w)(x) / (1 - y g(x)) mod y^m computed by Bostan-Mori over x with bivariate P and Q.
+    // Q does not depend on w, so its levels are computed first, then the transposed steps run back up
+    poly compose(const poly& g, int n) const {
+        int m = size();
+        if (n == 0) return poly();
+        if (m == 0) return poly<T>(n);
+        // bivariate polynomials are row major: x-rows of length ny
+        struct level { int nx, py, qy; std::vector<T> r; }; // R = Q(-x, y) of size nx x qy, P is nx x py
+        std::vector<level> lv;
+        int N = n - 1, py = 1, qy = std::min(2, m);
+        std::vector<T> Q((size_t)n * qy, T(0));
+        Q[0] = T(1);
+        if (qy == 2) for (int i = 0; i < n && i < g.size(); i++) Q[2 * i + 1] = -g.V[i];
+        while (N > 0) {
+            int nx = N + 1;
+            std::vector<T> R = Q;
+            for (int i = 1; i < nx; i += 2)
+                for (int j = 0; j < qy; j++) R[(size_t)i * qy + j] = -R[(size_t)i * qy + j];
+            // V = Q R (even in x), Kronecker substitution with row stride 2qy - 1
+            int vy = 2 * qy - 1, nqy = std::min(vy, m), nnx = N / 2 + 1;
+            std::vector<T> a((size_t)(nx - 1) * vy + qy), b((size_t)(nx - 1) * vy + qy), v((size_t)(2 * nx - 1) * vy);
+            for (int i = 0; i < nx; i++)
+                for (int j = 0; j < qy; j++) a[(size_t)i * vy + j] = Q[(size_t)i * qy + j], b[(size_t)i * vy + j] = R[(size_t)i * qy + j];
+            conv_raw(a.data(), a.size(), b.data(), b.size(), v.data());
+            std::vector<T> nq((size_t)nnx * nqy);
+            for (int i = 0; i < nnx; i++)
+                for (int j = 0; j < nqy; j++) nq[(size_t)i * nqy + j] = v[(size_t)2 * i * vy + j];
+            lv.push_back({nx, py, qy, std::move(R)});
+            py = std::min(py + qy - 1, m);
+            Q = std::move(nq);
+            qy = nqy;
+            N /= 2;
+        }
+
+        // top: a = P(0, y) / Q(0, y) mod y^m, transposed into the row P^T(0, y) = f^T (1 / Q(0, y))
+        poly<T> q0 = poly<T>(std::vector<T>(Q.begin(), Q.begin() + qy)).inv(m);
+        std::vector<T> f(V), pt(py);
+        f.resize(py + m - 1);
+        middle_product_raw(f.data(), q0.data(), m, pt.data(), py);
+        // each level: P^T <- R^T (embed P'^T at the rows of its parity), a 2-D middle product
+        N = 0;
+        for (int k = (int)lv.size() - 1; k >= 0; k--) {
+            const level& L = lv[k];
+            int nx = L.nx, uy = L.py + L.qy - 1, par = (nx - 1) & 1, nnx = (nx - 1) / 2 + 1;
+            int cur_py = pt.size() / nnx;
+            std::vector<T> u((size_t)(2 * nx - 1) * uy), r((size_t)(nx - 1) * uy + L.qy), npt((size_t)(nx - 1) * uy + L.py);
+            for (int i = 0; i < nnx; i++)
+                for (int j = 0; j < cur_py; j++) u[(size_t)(2 * i + par) * uy + j] = pt[(size_t)i * cur_py + j];
+            for (int i = 0; i < nx; i++)
+                for (int j = 0; j < L.qy; j++) r[(size_t)i * uy + j] = L.r[(size_t)i * L.qy + j];
+            middle_product_raw(u.data(), r.data(), r.size(), npt.data(), npt.size());
+            pt.assign((size_t)nx * L.py, T(0));
+            for (int i = 0; i < nx; i++)
+                for (int j = 0; j < L.py; j++) pt[(size_t)i * L.py + j] = npt[(size_t)i * uy + j];
+        }
+        // P_0 = rev(w) with one column, so h_j = P^T[n - 1 - j]
+        poly<T> res(n);
+        for (int j = 0; j < n; j++) res.V[j] = pt[n - 1 - j];
         return res;
     }
 
@@ -396,33 +1237,15 @@ public:
             }
             return results;
         }
-
-        vector<poly> tree(4 * n);
-
-        auto build = [&](auto&& self, int node, int l, int r) -> void {
-            if (l == r) { tree[node] = poly({-points[l], T(1)}); return; }
-            int mid = (l + r) / 2;
-            self(self, node * 2, l, mid);
-            self(self, node * 2 + 1, mid + 1, r);
-            
-            tree[node] = tree[node * 2] * tree[node * 2 + 1];
-        };
-        build(build, 1, 0, n - 1);
-        vector<T> results(n);        
-        poly start_poly = this->remainder(tree[1]); 
-
-        auto solve = [&](auto&& self, int node, int l, int r, const poly& f) -> void {
-            if (f.empty()) { for (int i = l; i <= r; i++) results[i] = T(0); return; }
-            if (l == r) { results[l] = f[0]; return; }
-            int mid = (l + r) / 2;
-            self(self, node * 2, l, mid, f.remainder(tree[node * 2]));
-            self(self, node * 2 + 1, mid + 1, r, f.remainder(tree[node * 2 + 1]));
-        };
-        solve(solve, 1, 0, n - 1, start_poly);
-        return results;
+        return subproduct_tree<T>(points).evaluate(*this);
     }
 
-    poly lagrange_interpolation(); // NOT IMPLEMENTED
+    // the polynomial of degree < n through (xs[i], ys[i]), xs pairwise distinct
+    static poly lagrange_interpolation(const vector<T>& xs, const vector<T>& ys) {
+        assert(xs.size() == ys.size());
+        if (xs.empty()) return poly();
+        return subproduct_tree<T>(xs).interpolate(ys);
+    }
 
     friend ostream& operator<<(ostream& os, const poly<T>& p) {
         for(int i = 0; i < p.size(); i++) 
@@ -431,15 +1254,360 @@ public:
     }
 };
 
+// convolution for any modulus < 2^31: three NTT primes, then Garner's CRT.
+// The result length n + m - 1 is limited to 2^24, the largest transform of p1 (p2 and p3 allow 2^25 and 2^26)
+template <typename T>
+poly<T> conv_crt(const poly<T> &A, const poly<T> &B) {
+    constexpr long long p1 = 754974721, p2 = 167772161, p3 = 469762049;
+    using m1 = mint<p1>; using m2 = mint<p2>; using m3 = mint<p3>;
+    int n = A.size(), m = B.size();
+    const long long max_len = std::min({ntt_max_size<m1>(), ntt_max_size<m2>(), ntt_max_size<m3>()});
+    assert((long long)n + m - 1 <= max_len && "conv_crt: result longer than the NTT primes support");
+    poly<m1> a1(n), b1(m);
+    poly<m2> a2(n), b2(m);
+    poly<m3> a3(n), b3(m);
+    for (int i = 0; i < n; i++) a1[i] = m1(A[i].val()), a2[i] = m2(A[i].val()), a3[i] = m3(A[i].val());
+    for (int i = 0; i < m; i++) b1[i] = m1(B[i].val()), b2[i] = m2(B[i].val()), b3[i] = m3(B[i].val());
+    poly<m1> c1 = conv(a1, b1);
+    poly<m2> c2 = conv(a2, b2);
+    poly<m3> c3 = conv(a3, b3);
+    int len = n + m - 1;
+    c1.resize(len); c2.resize(len); c3.resize(len);
+
+    const m2 inv_p1 = m2(p1).inv();
+    const m3 inv_p1p2 = m3(p1 * p2 % p3).inv();
+    const T p1p2 = T(p1 * p2);
+    poly<T> C(len);
+    for (int i = 0; i < len; i++) {
+        long long r1 = c1[i].val();
+        long long x12 = r1 + p1 * ((c2[i] - m2(r1)) * inv_p1).val();
+        long long t3 = ((c3[i] - m3(x12)) * inv_p1p2).val();
+        C[i] = T(x12) + p1p2 * T(t3);
+    }
+    return C;
+}
+
+// subproduct tree of prod (1 - x_i X) over the points, stored in one flat buffer.
+// nodes are numbered in preorder: the left child of v is v + 1, the right child v + 2 * |left|
+template <typename T>
+class subproduct_tree {
+private:
+    static constexpr int naive = 32;
+    int n;
+    std::vector<T> buf;   // node v keeps its |v| + 1 coefficients at buf[off[v]]
+    std::vector<int> off;
+    bool par = false;     // split across threads, only with tables grown up front (no CRT fallback)
+
+    static int ceil_pow2(int t) {
+        int m = 1;
+        while (m < t) m <<= 1;
+        return m;
+    }
+    static bool use_ntt(int len) { return ceil_pow2(len) <= ntt_max_size<T>(); }
+
+    void layout(int v, int l, int r, int& pos) {
+        off[v] = pos;
+        pos += r - l + 1;
+        if (r - l == 1) return;
+        int mid = (l + r) / 2;
+        layout(v + 1, l, mid, pos);
+        layout(v + 2 * (mid - l), mid, r, pos);
+    }
+    // subtrees below this many points are not split across threads
+    static constexpr int grain = 1 << 12;
+    template <typename F, typename G>
+    void fork(int len, F&& f, G&& g) const {
+        if (par && len >= grain) parallel::invoke(f, g);
+        else f(), g();
+    }
+
+    void build(int v, int l, int r, const std::vector<T>& xs) {
+        if (r - l == 1) {
+            buf[off[v]] = T(1);
+            buf[off[v] + 1] = -xs[l];
+            return;
+        }
+        int mid = (l + r) / 2, lc = v + 1, rc = v + 2 * (mid - l);
+        fork(r - l, [&] { build(lc, l, mid, xs); }, [&] { build(rc, mid, r, xs); });
+        conv_raw(&buf[off[lc]], mid - l + 1, &buf[off[rc]], r - mid + 1, &buf[off[v]]);
+    }
+
+    // g[l, r) = f^T (1 / Q_v) on entry, each leaf ends up with f(x_i)
+    void down(int v, int l, int r, T* g) const {
+        if (r - l == 1) return;
+        int mid = (l + r) / 2, lc = v + 1, rc = v + 2 * (mid - l), nl = mid - l, nr = r - mid;
+        const T* ql = &buf[off[lc]];
+        const T* qr = &buf[off[rc]];
+        {
+            typename poly_arena<T>::scope scope;
+            if (r - l <= naive || !use_ntt(r - l)) {
+                T* tmp = poly_arena<T>::alloc(r - l);
+                middle_product_raw(g + l, qr, nr + 1, tmp, nl);
+                middle_product_raw(g + l, ql, nl + 1, tmp + nl, nr);
+                std::copy(tmp, tmp + r - l, g + l);
+            } else {
+                // both middle products share the transform of g[l, r)
+                int m = ceil_pow2(r - l);
+                T* x = poly_arena<T>::alloc(m);
+                T* a = poly_arena<T>::alloc(m);
+                T* b = poly_arena<T>::alloc(m);
+                std::copy(g + l, g + r, x);
+                std::fill(x + (r - l), x + m, T(0));
+                std::reverse_copy(qr, qr + nr + 1, a);
+                std::fill(a + nr + 1, a + m, T(0));
+                std::reverse_copy(ql, ql + nl + 1, b);
+                std::fill(b + nl + 1, b + m, T(0));
+                ntt_dif(x, m);
+                ntt_dif(a, m);
+                ntt_dif(b, m);
+                ntt_pointwise(a, x, m);
+                ntt_pointwise(b, x, m);
+                ntt_dit(a, m);
+                ntt_dit(b, m);
+                std::copy(a + nr, a + nr + nl, g + l);
+                std::copy(b + nl, b + nl + nr, g + mid);
+            }
+        }
+        fork(r - l, [&] { down(lc, l, mid, g); }, [&] { down(rc, mid, r, g); });
+    }
+
+    // w[l, r) = weights on entry, reversed numerator sum_i w_i prod_{j != i} (1 - x_j X) on exit
+    void up(int v, int l, int r, T* w) const {
+        if (r - l == 1) return;
+        int mid = (l + r) / 2, lc = v + 1, rc = v + 2 * (mid - l), nl = mid - l, nr = r - mid;
+        fork(r - l, [&] { up(lc, l, mid, w); }, [&] { up(rc, mid, r, w); });
+        const T* ql = &buf[off[lc]];
+        const T* qr = &buf[off[rc]];
+        typename poly_arena<T>::scope scope;
+        if (r - l <= naive || !use_ntt(r - l)) {
+            T* tmp = poly_arena<T>::alloc(2 * (r - l));
+            conv_raw(w + l, nl, qr, nr + 1, tmp);
+            conv_raw(w + mid, nr, ql, nl + 1, tmp + (r - l));
+            for (int i = 0; i < r - l; i++) w[l + i] = tmp[i] + tmp[r - l + i];
+        } else {
+            int m = ceil_pow2(r - l);
+            T* a = poly_arena<T>::alloc(m);
+            T* b = poly_arena<T>::alloc(m);
+            T* c = poly_arena<T>::alloc(m);
+            T* d = poly_arena<T>::alloc(m);
+            std::fill(a, a + m, T(0));
+            std::fill(b, b + m, T(0));
+            std::fill(c, c + m, T(0));
+            std::fill(d, d + m, T(0));
+            std::copy(w + l, w + mid, a);
+            std::copy(qr, qr + nr + 1, b);
+            std::copy(w + mid, w + r, c);
+            std::copy(ql, ql + nl + 1, d);
+            ntt_dif(a, m);
+            ntt_dif(b, m);
+            ntt_dif(c, m);
+            ntt_dif(d, m);
+            ntt_pointwise(a, b, m);
+            ntt_pointwise(c, d, m);
+            for (int i = 0; i < m; i++) a[i] += c[i];
+            ntt_dit(a, m);
+            std::copy(a, a + r - l, w + l);
+        }
+    }
+
+public:
+    // subtrees are built and descended in parallel when parallel::set_threads asked for more than one thread
+    subproduct_tree(const std::vector<T>& xs) : n(xs.size()), off(std::max(2 * n - 1, 0)) {
+        if (n == 0) return;
+        int pos = 0;
+        layout(0, 0, n, pos);
+        buf.resize(pos);
+        if (use_ntt(n + 1)) {
+            ntt_reserve<T>(ceil_pow2(n + 1));
+            par = parallel::threads() > 1;
+        }
+        build(0, 0, n, xs);
+    }
+    int size() const { return n; }
+    // prod (1 - x_i X) over all points
+    poly<T> root() const { return poly<T>(std::vector<T>(buf.begin(), buf.begin() + std::min<int>(buf.size(), n + 1))); }
+
+    // f(x_i) for every point, by the transposed algorithm: g_root = f^T (1 / Q_root), then
+    // g_left = g^T Q_right and g_right = g^T Q_left down to the leaves
+    std::vector<T> evaluate(const poly<T>& f) const {
+        if (n == 0) return {};
+        int m = f.size();
+        if (m == 0) return std::vector<T>(n, T(0));
+        std::vector<T> a(f.begin(), f.end()), g(n);
+        a.resize(n + m - 1);
+        poly<T> h = root().inv(m);
+        middle_product_raw(a.data(), &h[0], m, g.data(), n);
+        down(0, 0, n, g.data());
+        return g;
+    }
+
+    // the polynomial of degree < n taking ys[i] at x_i: sum_i ys[i] / M'(x_i) prod_{j != i} (X - x_j)
+    // with M = prod (X - x_i), built reversed by Ñ_v = Ñ_left Q_right + Ñ_right Q_left
+    poly<T> interpolate(const std::vector<T>& ys) const {
+        assert((int)ys.size() == n);
+        if (n == 0) return poly<T>();
+        std::vector<T> dm(n);
+        for (int k = 1; k <= n; k++) dm[k - 1] = buf[n - k] * T(k);
+        std::vector<T> w = evaluate(poly<T>(dm));
+        for (int i = 0; i < n; i++) {
+            assert(w[i] != T(0));
+            w[i] = ys[i] / w[i];
+        }
+        up(0, 0, n, w.data());
+        std::reverse(w.begin(), w.end());
+        return poly<T>(std::move(w));
+    }
+};
+
+// product of ps[l, r), split where the total length halves
+template <typename T>
+poly<T> product(const std::vector<poly<T>>& ps, const std::vector<long long>& pre, int l, int r, bool par) {
+    if (r - l == 1) return ps[l];
+    int mid = std::upper_bound(pre.begin() + l + 1, pre.begin() + r, (pre[l] + pre[r]) / 2) - pre.begin();
+    mid = std::clamp(mid - 1, l + 1, r - 1);
+    poly<T> a, b;
+    if (par && pre[r] - pre[l] >= (1 << 12))
+        parallel::invoke([&] { a = product(ps, pre, l, mid, par); }, [&] { b = product(ps, pre, mid, r, par); });
+    else
+        a = product(ps, pre, l, mid, par), b = product(ps, pre, mid, r, par);
+    return a * b;
+}
+// product of all ps, halves run on the pool of parallel::set_threads when the modulus allows a plain NTT
+template <typename T>
+poly<T> product(const std::vector<poly<T>>& ps) {
+    if (ps.empty()) return poly<T>(T(1));
+    std::vector<long long> pre(ps.size() + 1);
+    for (size_t i = 0; i < ps.size(); i++) pre[i + 1] = pre[i] + ps[i].size();
+    long long m = 1;
+    while (m < pre.back()) m <<= 1;
+    bool par = parallel::threads() > 1 && m <= ntt_max_size<T>();
+    if (par) ntt_reserve<T>(m);
+    return product(ps, pre, 0, ps.size(), par);
+}
+
+// [x^N] P / Q for Q(0) != 0 by Bostan-Mori: P(x) / Q(x) = P(x) Q(-x) / Q(x) Q(-x), keep the half of the numerator
+// with the parity of N and halve N. P and Q stay in length 2m transforms between steps: in bit-reversed order
+// Q(-x) is Q with neighbours swapped, the halved images come out at length m, and the upper half of the next
+// length 2m image is the length m transform of the coefficients twisted by w_{2m}^i
+template <typename T>
+T kth_coefficient(const poly<T>& P, const poly<T>& Q, long long N) {
+    assert(!Q.empty() && *Q.begin() != T(0));
+    if (P.empty()) return T(0);
+    int m = 1;
+    while (m < std::max(P.size(), Q.size())) m <<= 1;
+    std::vector<T> p(P.begin(), P.end()), q(Q.begin(), Q.end());
+    auto finish = [&](int len) {
+        p.resize(len);
+        q.resize(len);
+        poly<T> iq = poly<T>(q).inv(N + 1);
+        T res = T(0);
+        for (int i = 0; i <= N; i++) res += p[i] * iq[N - i];
+        return res;
+    };
+    if (N < m) return finish(m);
+
+    if (2 * m > ntt_max_size<T>()) {
+        poly<T> a = P, b = Q;
+        while (N >= m) {
+            poly<T> c = b;
+            for (int i = 1; i < c.size(); i += 2) c[i] = -c[i];
+            poly<T> u = a * c, v = b * c;
+            std::vector<T> na, nb;
+            for (int i = N & 1; i < u.size(); i += 2) na.push_back(u[i]);
+            for (int i = 0; i < v.size(); i += 2) nb.push_back(v[i]);
+            a = poly<T>(std::move(na)), b = poly<T>(std::move(nb));
+            N >>= 1;
+        }
+        p.assign(a.begin(), a.end());
+        q.assign(b.begin(), b.end());
+        return finish(m);
+    }
+
+    using table = ntt_table<T>;
+    ntt_reserve<T>(2 * m);
+    const T inv2 = T(2).inv();
+    // ipw[i] = w_{2m}^{-rev_m(i)} / 2 is 1 / 2s for the pair (s, -s) at 2i, 2i + 1; tw[i] = w_{2m}^i
+    std::vector<T> ipw(m), tw(m);
+    std::vector<int> rev(m, 0);
+    int lg = __builtin_ctz(m);
+    for (int i = 1; i < m; i++) rev[i] = (rev[i >> 1] >> 1) | ((i & 1) << (lg - 1));
+    for (int i = 0; i < m; i++) {
+        ipw[i] = table::irt[m + rev[i]] * inv2;
+        tw[i] = table::rt[m + i];
+    }
+    p.resize(2 * m);
+    q.resize(2 * m);
+    ntt_dif(p.data(), 2 * m);
+    ntt_dif(q.data(), 2 * m);
+    while (true) {
+        for (int i = 0; i < m; i++) {
+            T p0 = p[2 * i], p1 = p[2 * i + 1], q0 = q[2 * i], q1 = q[2 * i + 1];
+            p[i] = (N & 1) ? (p0 * q1 - p1 * q0) * ipw[i] : (p0 * q1 + p1 * q0) * inv2;
+            q[i] = q0 * q1;
+        }
+        N >>= 1;
+        if (N < m) break;
+        for (T* a : {p.data(), q.data()}) {
+            std::copy(a, a + m, a + m);
+            ntt_dit(a + m, m);
+            ntt_pointwise(a + m, tw.data(), m);
+            ntt_dif(a + m, m);
+        }
+    }
+    ntt_dit(p.data(), m);
+    ntt_dit(q.data(), m);
+    return finish(m);
+}
+
+// shortest recurrence sum_{j <= L} C_j s_{i - j} = 0 (C_0 = 1) for the sequence, returned as C of size L + 1
+template <typename T>
+poly<T> berlekamp_massey(const std::vector<T>& s) {
+    std::vector<T> C{T(1)}, B{T(1)};
+    int L = 0, m = 1;
+    T b = T(1);
+    for (int n = 0; n < (int)s.size(); n++) {
+        T d = s[n];
+        for (int i = 1; i <= L; i++) d += C[i] * s[n - i];
+        if (d == T(0)) { m++; continue; }
+        std::vector<T> prev = C;
+        T coef = d / b;
+        if (C.size() < B.size() + m) C.resize(B.size() + m);
+        for (int i = 0; i < (int)B.size(); i++) C[i + m] -= coef * B[i];
+        if (2 * L <= n) {
+            L = n + 1 - L;
+            B = std::move(prev);
+            b = d;
+            m = 1;
+        } else m++;
+    }
+    poly<T> res(L + 1);
+    for (int i = 0; i <= L; i++) res[i] = C[i];
+    return res;
+}
+
+// N-th term of the linearly recurrent sequence starting with s (s should hold at least twice the order)
+template <typename T>
+T linear_recurrence_kth(const std::vector<T>& s, long long N) {
+    if (N < (long long)s.size()) return s[N];
+    poly<T> Q = berlekamp_massey(s);
+    int d = Q.size() - 1;
+    if (d == 0) return T(0);
+    poly<T> P = poly<T>(std::vector<T>(s.begin(), s.begin() + d)) * Q % d;
+    return kth_coefficient(P, Q, N);
+}
+
 template <typename T> poly<T> derivate(poly<T>& p) { return p.derivate(); }
 template <typename T> poly<T> integrate(poly<T>& p) { return p.integrate(); }
 template <typename T> poly<T> inv(poly<T>& p, int t) { return p.inv(p.size(), t); }
 template <typename T> poly<T> log(poly<T>& p, int t) { return p.log(t); }
 template <typename T> poly<T> exp(poly<T>& p, int t) { return p.exp(t); }
+template <typename T> poly<T> sqrt(const poly<T>& p, int t) { return p.sqrt(t); }
 template <typename T> poly<T> pow(poly<T>& p, long long k, int t) { return p.pow(k, t); }
 template <typename T> std::pair<poly<T>, poly<T>> divide_and_remainder(const poly<T>& f, const poly<T>& g) { return f.divide_and_remainder(g); }
 template <typename T> poly<T> remainder(const poly<T>& f, const poly<T>& g) { return f.remainder(g); }
 template <typename T> poly<T> taylor_shift(const poly<T>& f, T c) { return f.taylor_shift(c); }
+template <typename T> poly<T> compose(const poly<T>& f, const poly<T>& g, int n) { return f.compose(g, n); }
 template <typename T> std::vector<T> multipoint_evaluation(const poly<T>& f, const std::vector<T>& points) { return f.multipoint_evaluation(points); }
+template <typename T> poly<T> lagrange_interpolation(const std::vector<T>& xs, const std::vector<T>& ys) { return poly<T>::lagrange_interpolation(xs, ys); }
 
 #endif // POLY_H 
\ No newline at end of file
@@ -1,66 +1,386 @@
 #ifndef SEGMENT_TREE_H
 #define SEGMENT_TREE_H
 
+#include <vector>
+#include <span>
+#include <utility>
+#include "include/threadpool.h"
+
+// Positions are 1-indexed and ranges inclusive, as a[1..s]; a, when given, is read from a[1..s].
+// Segtree and LazySegtree are iterative over a power-of-two leaf layer: leaf i lives at seg[sz + i - 1], node k covers
+// its children 2k and 2k+1, and the padding leaves hold the identity. op only needs to be associative.
+
 template <typename T, T(*op)(T, T), T I>
 struct Segtree {
 
     // Variables
-    T *arr;
-    int arr_size, seg_size;
-    T *seg;
+    int arr_size, lg, sz;
+    std::vector<T> seg;
 
     // Constructor
-    Segtree(int s, T *a = NULL) {
-        arr = a; arr_size = s;
-        seg_size = arr_size * 4 + 1;
-        seg = new T[seg_size];
-        build(1, 1, arr_size);
-    }
-    T build(int node_index, int left, int right) {
-        if(left == right) {
-            return seg[node_index] = arr?arr[left]:I;
+    Segtree(int s, T *a = NULL) : arr_size(s) {
+        lg = 0;
+        while ((1 << lg) < arr_size) lg++;
+        sz = 1 << lg;
+        seg.assign(2 * sz, I);
+        if (a) for (int i = 1; i <= arr_size; i++) seg[sz + i - 1] = a[i];
+        for (int k = sz - 1; k >= 1; k--) pull(k);
+    }
+
+    // Features
+    void pull(int k) { seg[k] = op(seg[2 * k], seg[2 * k + 1]); }
+
+    // Interfaces
+    void update(int pos, T val) {
+        pos += sz - 1;
+        seg[pos] = val;
+        for (pos >>= 1; pos; pos >>= 1) pull(pos);
+    }
+    T get(int pos) const { return seg[pos + sz - 1]; }
+    T get(int st, int en) const {
+        if (st < 1) st = 1;
+        if (en > arr_size) en = arr_size;
+        if (st > en) return I;
+        T sml = I, smr = I;
+        int l = st + sz - 1, r = en + sz;
+        while (l < r) {
+            if (l & 1) sml = op(sml, seg[l++]);
+            if (r & 1) smr = op(seg[--r], smr);
+            l >>= 1; r >>= 1;
         }
-        int mid = (left + right) / 2;
-        T l = build(node_index * 2, left, mid);
-        T r = build(node_index * 2 + 1, mid+1, right);
-        return seg[node_index] = op(l, r);
+        return op(sml, smr);
     }
 
-    // Destructor
-    ~Segtree() {delete[] seg;}
+    // Batches. Read-only batches fan out over parallel::for_range; results come back in query order.
+    // A large batch is answered offline: queries are bucketed by the level h where their two leaves part,
+    // and for each such level one O(n) pass stores suffix folds of every left half and prefix folds of every
+    // right half, so each query becomes a single op(tmp[l], tmp[r]).
+    std::vector<T> get_many(std::span<const std::pair<int, int>> qs) const {
+        std::vector<T> res(qs.size(), I);
+        if (qs.size() * 4 < (size_t)sz) {
+            parallel::for_range(0, qs.size(), 1 << 14, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++) res[i] = get(qs[i].first, qs[i].second);
+            });
+            return res;
+        }
+        struct item { unsigned x, y, id; };
+        std::vector<unsigned> start(lg + 2, 0);
+        auto level = [&](const std::pair<int, int>& q, unsigned& x, unsigned& y) {
+            int st = std::max(q.first, 1), en = std::min(q.second, arr_size);
+            if (st > en) return -1;
+            x = st - 1, y = en - 1;
+            return x == y ? 0 : 32 - __builtin_clz(x ^ y);
+        };
+        unsigned x, y;
+        for (auto& q : qs) { int h = level(q, x, y); if (h >= 0) start[h + 1]++; }
+        for (int h = 0; h <= lg; h++) start[h + 1] += start[h];
+        std::vector<item> items(start[lg + 1]);
+        std::vector<unsigned> pos(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < qs.size(); i++) {
+            int h = level(qs[i], x, y);
+            if (h >= 0) items[pos[h]++] = {x, y, (unsigned)i};
+        }
+        for (unsigned k = start[0]; k < start[1]; k++) res[items[k].id] = seg[sz + items[k].x];
+        parallel::for_range(1, lg + 1, 1, [&](size_t lo, size_t hi) {
+            std::vector<T> tmp(sz);
+            for (size_t h = lo; h < hi; h++) {
+                if (start[h] == start[h + 1]) continue;
+                const int half = 1 << (h - 1);
+                for (int b = 0; b < sz; b += 2 * half) {
+                    T acc = I;
+                    for (int p = b + half - 1; p >= b; p--) tmp[p] = acc = op(seg[sz + p], acc);
+                    acc = I;
+                    for (int p = b + half; p < b + 2 * half; p++) tmp[p] = acc = op(acc, seg[sz + p]);
+                }
+                for (unsigned k = start[h]; k < start[h + 1]; k++) res[items[k].id] = op(tmp[items[k].x], tmp[items[k].y]);
+            }
+        });
+        return res;
+    }
+    // applies update(pos, val) in order, a batch large enough to touch most of the tree is rebuilt in O(n)
+    void update_many(std::span<const std::pair<int, T>> ups) {
+        if (ups.size() * lg < (size_t)sz) {
+            for (auto& [pos, val] : ups) update(pos, val);
+            return;
+        }
+        for (auto& [pos, val] : ups) seg[sz + pos - 1] = val;
+        for (int k = sz - 1; k >= 1; k--) pull(k);
+    }
+
+    // largest r in [l-1, arr_size] with f(get(l, r)), f must be monotone and f(I) true
+    template <typename G>
+    int max_right(int l, G f) const {
+        if (l > arr_size) return arr_size;
+        l += sz - 1;
+        T sm = I;
+        do {
+            while (l % 2 == 0) l >>= 1;
+            if (!f(op(sm, seg[l]))) {
+                while (l < sz) {
+                    l = 2 * l;
+                    if (f(op(sm, seg[l]))) sm = op(sm, seg[l++]);
+                }
+                return l - sz;
+            }
+            sm = op(sm, seg[l++]);
+        } while ((l & -l) != l);
+        return arr_size;
+    }
+    // smallest l in [1, r+1] with f(get(l, r)), f must be monotone and f(I) true
+    template <typename G>
+    int min_left(int r, G f) const {
+        if (r < 1) return 1;
+        r += sz;
+        T sm = I;
+        do {
+            r--;
+            while (r > 1 && (r % 2)) r >>= 1;
+            if (!f(op(seg[r], sm))) {
+                while (r < sz) {
+                    r = 2 * r + 1;
+                    if (f(op(seg[r], sm))) sm = op(seg[r--], sm);
+                }
+                return r + 2 - sz;
+            }
+            sm = op(seg[r], sm);
+        } while ((r & -r) != r);
+        return 1;
+    }
+};
+
+// Range apply / range fold. mapping(f, x) applies f to a folded value, composition(f, g) is "g, then f",
+// and ID is the identity map. Values that depend on the segment length (range add on sums) carry the length in T.
+template <typename T, T(*op)(T, T), T I, typename F, T(*mapping)(F, T), F(*composition)(F, F), F ID>
+struct LazySegtree {
+
+    // Variables
+    int arr_size, lg, sz;
+    std::vector<T> seg;
+    std::vector<F> lazy;
+
+    // Constructor
+    LazySegtree(int s, T *a = NULL) : arr_size(s) {
+        lg = 0;
+        while ((1 << lg) < arr_size) lg++;
+        sz = 1 << lg;
+        seg.assign(2 * sz, I);
+        lazy.assign(sz, ID);
+        if (a) for (int i = 1; i <= arr_size; i++) seg[sz + i - 1] = a[i];
+        for (int k = sz - 1; k >= 1; k--) pull(k);
+    }
 
     // Features
-    T _get(int st, int en, int node_index, int left, int right) {
-        if(en < left or right < st) return T(I);
-        if(st <= left and right <= en) return seg[node_index];
-        int mid = (left + right) / 2;
-        T l = _get(st, en, node_index * 2, left, mid);
-        T r = _get(st, en, node_index * 2 + 1, mid+1, right);
-        return op(l, r);
-    }
-    T _update(int pos, T v, int node_index, int left, int right) {
-        if(pos < left or right < pos) return seg[node_index];
-        if(left == right and left == pos) {
-            arr[pos] = v;
-            return seg[node_index] = v;
+    void pull(int k) { seg[k] = op(seg[2 * k], seg[2 * k + 1]); }
+    void all_apply(int k, F f) {
+        seg[k] = mapping(f, seg[k]);
+        if (k < sz) lazy[k] = composition(f, lazy[k]);
+    }
+    void push(int k) {
+        all_apply(2 * k, lazy[k]);
+        all_apply(2 * k + 1, lazy[k]);
+        lazy[k] = ID;
+    }
+    // pushes every pending map on the paths to the boundaries of the leaf range [l, r)
+    void push_bounds(int l, int r) {
+        for (int i = lg; i >= 1; i--) {
+            if (((l >> i) << i) != l) push(l >> i);
+            if (((r >> i) << i) != r) push((r - 1) >> i);
         }
-        int mid = (left + right) / 2;
-        T l = _update(pos, v, node_index * 2, left, mid);
-        T r = _update(pos, v, node_index * 2 + 1, mid+1, right);
-        return seg[node_index] = op(l, r);
     }
 
     // Interfaces
     void update(int pos, T val) {
-        _update(pos, val, 1, 1, arr_size);
+        pos += sz - 1;
+        for (int i = lg; i >= 1; i--) push(pos >> i);
+        seg[pos] = val;
+        for (int i = 1; i <= lg; i++) pull(pos >> i);
+    }
+    T get(int pos) {
+        pos += sz - 1;
+        for (int i = lg; i >= 1; i--) push(pos >> i);
+        return seg[pos];
     }
     T get(int st, int en) {
-        return _get(st, en, 1, 1, arr_size);
+        if (st < 1) st = 1;
+        if (en > arr_size) en = arr_size;
+        if (st > en) return I;
+        int l = st + sz - 1, r = en + sz;
+        push_bounds(l, r);
+        T sml = I, smr = I;
+        while (l < r) {
+            if (l & 1) sml = op(sml, seg[l++]);
+            if (r & 1) smr = op(seg[--r], smr);
+            l >>= 1; r >>= 1;
+        }
+        return op(sml, smr);
+    }
+    void apply(int pos, F f) {
+        pos += sz - 1;
+        for (int i = lg; i >= 1; i--) push(pos >> i);
+        seg[pos] = mapping(f, seg[pos]);
+        for (int i = 1; i <= lg; i++) pull(pos >> i);
+    }
+    void apply(int st, int en, F f) {
+        if (st < 1) st = 1;
+        if (en > arr_size) en = arr_size;
+        if (st > en) return;
+        int l = st + sz - 1, r = en + sz;
+        push_bounds(l, r);
+        for (int a = l, b = r; a < b; a >>= 1, b >>= 1) {
+            if (a & 1) all_apply(a++, f);
+            if (b & 1) all_apply(--b, f);
+        }
+        for (int i = 1; i <= lg; i++) {
+            if (((l >> i) << i) != l) pull(l >> i);
+            if (((r >> i) << i) != r) pull((r - 1) >> i);
+        }
+    }
+
+    // largest r in [l-1, arr_size] with f(get(l, r)), f must be monotone and f(I) true
+    template <typename G>
+    int max_right(int l, G f) {
+        if (l > arr_size) return arr_size;
+        l += sz - 1;
+        for (int i = lg; i >= 1; i--) push(l >> i);
+        T sm = I;
+        do {
+            while (l % 2 == 0) l >>= 1;
+            if (!f(op(sm, seg[l]))) {
+                while (l < sz) {
+                    push(l);
+                    l = 2 * l;
+                    if (f(op(sm, seg[l]))) sm = op(sm, seg[l++]);
+                }
+                return l - sz;
+            }
+            sm = op(sm, seg[l++]);
+        } while ((l & -l) != l);
+        return arr_size;
+    }
+    // smallest l in [1, r+1] with f(get(l, r)), f must be monotone and f(I) true
+    template <typename G>
+    int min_left(int r, G f) {
+        if (r < 1) return 1;
+        r += sz;
+        for (int i = lg; i >= 1; i--) push((r - 1) >> i);
+        T sm = I;
+        do {
+            r--;
+            while (r > 1 && (r % 2)) r >>= 1;
+            if (!f(op(seg[r], sm))) {
+                while (r < sz) {
+                    push(r);
+                    r = 2 * r + 1;
+                    if (f(op(seg[r], sm))) sm = op(seg[r--], sm);
+                }
+                return r + 2 - sz;
+            }
+            sm = op(seg[r], sm);
+        } while ((r & -r) != r);
+        return 1;
+    }
+};
+
+// Persistent point-update / range-fold tree. Every update copies the lg + 1 nodes on one root-to-leaf path
+// and returns a new root, older roots stay valid. Nodes come from an index pool kept as parallel arrays
+// (32-bit children, values), node 0 is the shared all-identity subtree, so an empty version costs nothing.
+template <typename T, T(*op)(T, T), T I>
+struct PersistentSegtree {
+
+    // Variables
+    int arr_size, lg, sz;
+    std::vector<unsigned> lc, rc;
+    std::vector<T> val;
+    unsigned root; // version built by the constructor
+
+    // Constructor, updates = expected number of updates, used to size the pool up front
+    PersistentSegtree(int s, T *a = NULL, int updates = 0) : arr_size(s) {
+        lg = 0;
+        while ((1 << lg) < arr_size) lg++;
+        sz = 1 << lg;
+        reserve((a ? 2 * sz : 1) + (size_t)updates * (lg + 1));
+        lc.push_back(0); rc.push_back(0); val.push_back(I);
+        root = 0;
+        if (!a) return;
+        std::vector<unsigned> level(sz, 0);
+        for (int i = 1; i <= arr_size; i++) level[i - 1] = new_node(0, 0, a[i]);
+        for (int w = sz / 2; w >= 1; w /= 2)
+            for (int i = 0; i < w; i++) {
+                unsigned l = level[2 * i], r = level[2 * i + 1];
+                level[i] = new_node(l, r, op(val[l], val[r]));
+            }
+        root = level[0];
+    }
+
+    // Features
+    void reserve(size_t nodes) { lc.reserve(nodes); rc.reserve(nodes); val.reserve(nodes); }
+    unsigned new_node(unsigned l, unsigned r, T v) {
+        lc.push_back(l); rc.push_back(r); val.push_back(v);
+        return val.size() - 1;
+    }
+    // copies the path to pos, sets the leaf to f(old leaf) and refolds the copies
+    template <typename G>
+    unsigned _update(unsigned x, int pos, G f) {
+        unsigned path[32];
+        unsigned p = pos - 1;
+        unsigned nw = path[0] = new_node(lc[x], rc[x], val[x]);
+        for (int i = lg - 1; i >= 0; i--) {
+            x = (p >> i & 1) ? rc[x] : lc[x];
+            unsigned c = new_node(lc[x], rc[x], val[x]);
+            ((p >> i & 1) ? rc[nw] : lc[nw]) = c;
+            nw = path[lg - i] = c;
+        }
+        val[nw] = f(val[nw]);
+        for (int d = lg - 1; d >= 0; d--) val[path[d]] = op(val[lc[path[d]]], val[rc[path[d]]]);
+        return path[0];
+    }
+
+    // Interfaces
+    unsigned update(unsigned rt, int pos, T v) { return _update(rt, pos, [&](T) { return v; }); }
+    unsigned apply(unsigned rt, int pos, T v) { return _update(rt, pos, [&](T old) { return op(old, v); }); }
+    size_t nodes() const { return val.size(); }
+
+    T get(unsigned rt, int pos) const {
+        for (int i = lg - 1; i >= 0; i--) rt = ((pos - 1) >> i & 1) ? rc[rt] : lc[rt];
+        return val[rt];
+    }
+    T get(unsigned rt, int st, int en) const {
+        if (st < 1) st = 1;
+        if (en > arr_size) en = arr_size;
+        if (st > en) return I;
+        unsigned l = st - 1, r = en - 1, x = rt;
+        int i = lg - 1;
+        for (; i >= 0 && (l >> i & 1) == (r >> i & 1); i--) x = (l >> i & 1) ? rc[x] : lc[x];
+        if (i < 0) return val[x];
+        // l and r split below x: collect what lies right of l's path and left of r's path
+        T sml = I, smr = I;
+        unsigned a = lc[x], b = rc[x];
+        for (int j = i - 1; j >= 0; j--) {
+            if (l >> j & 1) a = rc[a];
+            else sml = op(val[rc[a]], sml), a = lc[a];
+            if (r >> j & 1) smr = op(smr, val[lc[b]]), b = rc[b];
+            else b = lc[b];
+        }
+        return op(op(val[a], sml), op(smr, val[b]));
+    }
+
+    // counting trees (op = +): smallest p with sum over [1, p] of (hi - lo) >= k, arr_size + 1 if there is none;
+    // with version i = version i - 1 plus one at a[i], kth(root[l - 1], root[r], k) is the k-th smallest of a[l..r]
+    int kth(unsigned lo, unsigned hi, T k) const {
+        if (val[hi] - val[lo] < k) return arr_size + 1;
+        int p = 0;
+        for (int i = lg - 1; i >= 0; i--) {
+            T c = val[lc[hi]] - val[lc[lo]];
+            if (k <= c) hi = lc[hi], lo = lc[lo];
+            else k -= c, hi = rc[hi], lo = rc[lo], p |= 1 << i;
+        }
+        return p + 1;
     }
 };
+
 long long sum_op(long long a, long long b) {
     return a + b;
 }
 using Seg = Segtree<long long, sum_op, 0LL>;
 
-#endif // SEGMENT_TREE_H
\ No newline at end of file
+#endif // SEGMENT_TREE_H
@@ -0,0 +1,117 @@
+#ifndef STATIC_RANGE_H
+#define STATIC_RANGE_H
+
+#include <vector>
+#include <new>
+#include <cstddef>
+
+// Read-only range folds built once from a[1..s], for query-heavy workloads.
+// Same conventions as Segtree: template <T, op, I>, 1-indexed positions, inclusive get(st, en).
+
+// O(1) query, op must be idempotent (min, max, gcd, and, or)
+template <typename T, T(*op)(T, T), T I>
+struct SparseTable {
+
+    // Variables
+    int arr_size;
+    std::vector<std::vector<T>> table; // table[k][i] = op over a[i + 1 .. i + 2^k]
+
+    // Constructor
+    SparseTable(int s, const T *a) : arr_size(s) {
+        int levels = 1;
+        while ((1 << levels) <= arr_size) levels++;
+        table.resize(levels);
+        table[0].assign(a + 1, a + arr_size + 1);
+        for (int k = 1; k < levels; k++) {
+            int half = 1 << (k - 1), cnt = arr_size - (1 << k) + 1;
+            table[k].resize(cnt);
+            for (int i = 0; i < cnt; i++) table[k][i] = op(table[k - 1][i], table[k - 1][i + half]);
+        }
+    }
+
+    // Interfaces
+    T get(int pos) const { return table[0][pos - 1]; }
+    T get(int st, int en) const {
+        if (st < 1) st = 1;
+        if (en > arr_size) en = arr_size;
+        if (st > en) return I;
+        int k = 31 - __builtin_clz(en - st + 1);
+        return op(table[k][st - 1], table[k][en - (1 << k)]);
+    }
+};
+
+// allocator handing out 64-byte aligned storage, so that B-entry blocks line up with cache lines
+template <typename T>
+struct cacheline_allocator {
+    using value_type = T;
+    cacheline_allocator() = default;
+    template <typename U> cacheline_allocator(const cacheline_allocator<U>&) {}
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(64))); }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(64)); }
+    template <typename U> bool operator==(const cacheline_allocator<U>&) const { return true; }
+};
+
+// B-ary tree, op only needs to be associative.
+// Every block of B entries on a level also stores its prefix and suffix folds, so a query reads
+// one suffix and one prefix per level and climbs log_B(n) levels; only a range that ends inside a single
+// block is folded entry by entry. val, pre and suf are separate 64-byte aligned arrays and every level starts
+// on a block boundary, so when sizeof(T) divides 64 a block of any of them is exactly one cache line and a
+// query touches at most two lines per level.
+template <typename T, T(*op)(T, T), T I>
+struct WideSegtree {
+    static constexpr int B = sizeof(T) >= 32 ? 2 : 64 / sizeof(T);
+
+    // Variables
+    int arr_size;
+    std::vector<int> offset;                 // start of each level in the flat arrays, level 0 = leaves
+    std::vector<T, cacheline_allocator<T>> val, pre, suf;
+
+    // Constructor
+    WideSegtree(int s, const T *a) : arr_size(s) {
+        int cnt = arr_size;
+        do {
+            int padded = (cnt + B - 1) / B * B;
+            offset.push_back(val.size());
+            val.resize(val.size() + padded, I);
+            cnt = padded / B;
+        } while (cnt > 1);
+        offset.push_back(val.size());
+        pre.resize(val.size());
+        suf.resize(val.size());
+        for (int i = 0; i < arr_size; i++) val[i] = a[i + 1];
+        for (int h = 0; h + 1 < (int)offset.size(); h++) {
+            for (int b = offset[h]; b < offset[h + 1]; b += B) {
+                pre[b] = val[b];
+                for (int j = 1; j < B; j++) pre[b + j] = op(pre[b + j - 1], val[b + j]);
+                suf[b + B - 1] = val[b + B - 1];
+                for (int j = B - 2; j >= 0; j--) suf[b + j] = op(val[b + j], suf[b + j + 1]);
+                if (h + 2 < (int)offset.size()) val[offset[h + 1] + (b - offset[h]) / B] = pre[b + B - 1];
+            }
+        }
+    }
+
+    // Interfaces
+    T get(int pos) const { return val[pos - 1]; }
+    T get(int st, int en) const {
+        if (st < 1) st = 1;
+        if (en > arr_size) en = arr_size;
+        if (st > en) return I;
+        T sml = I, smr = I;
+        unsigned l = st - 1, r = en; // [l, r) on the current level
+        for (int h = 0; l < r; h++) {
+            const unsigned o = offset[h];
+            if (l / B == (r - 1) / B) {
+                if (l % B == 0) sml = op(sml, pre[o + r - 1]);
+                else if (r % B == 0) sml = op(sml, suf[o + l]);
+                else for (unsigned i = l; i < r; i++) sml = op(sml, val[o + i]);
+                break;
+            }
+            if (l % B) sml = op(sml, suf[o + l]), l = (l / B + 1) * B;
+            if (r % B) smr = op(pre[o + r - 1], smr), r = r / B * B;
+            l /= B; r /= B;
+        }
+        return op(sml, smr);
+    }
+};
+
+#endif // STATIC_RANGE_H
@@ -0,0 +1,105 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H // fork-join task pool
+
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+
+// workers take the oldest task (the largest split), a thread waiting on a join runs the newest ones itself,
+// so nested fork-join never blocks a worker while its own subtask is still queued
+class thread_pool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop = false;
+
+    void worker() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return stop || !tasks.empty(); });
+                if (stop && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+    bool run_newest() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (tasks.empty()) return false;
+            task = std::move(tasks.back());
+            tasks.pop_back();
+        }
+        task();
+        return true;
+    }
+
+public:
+    explicit thread_pool(int threads) {
+        for (int i = 1; i < threads; i++) workers.emplace_back([this] { worker(); });
+    }
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // threads taking part in the work, the caller included
+    int size() const { return workers.size() + 1; }
+
+    // run f and g, g possibly on another thread, and return once both are done
+    template <typename F, typename G>
+    void invoke(F&& f, G&& g) {
+        if (workers.empty()) { f(); g(); return; }
+        std::atomic<bool> done{false};
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.emplace_back([&] { g(); done.store(true, std::memory_order_release); });
+        }
+        cv.notify_one();
+        f();
+        while (!done.load(std::memory_order_acquire))
+            if (!run_newest()) std::this_thread::yield();
+    }
+};
+
+// process wide pool, sequential until set_threads is called with more than one thread
+namespace parallel {
+    inline std::unique_ptr<thread_pool> pool = std::make_unique<thread_pool>(1);
+
+    inline void set_threads(int threads) {
+        if (threads < 1) threads = std::max(1u, std::thread::hardware_concurrency());
+        if (threads != pool->size()) pool = std::make_unique<thread_pool>(threads);
+    }
+    inline int threads() { return pool->size(); }
+
+    template <typename F, typename G>
+    void invoke(F&& f, G&& g) { pool->invoke(std::forward<F>(f), std::forward<G>(g)); }
+
+    // f(lo, hi) over disjoint pieces of [begin, end), halved until a piece is at most grain long
+    template <typename F>
+    void for_range(size_t begin, size_t end, size_t grain, F&& f) {
+        if (pool->size() == 1 || end - begin <= grain) { if (begin < end) f(begin, end); return; }
+        size_t mid = begin + (end - begin) / 2;
+        invoke([&] { for_range(begin, mid, grain, f); }, [&] { for_range(mid, end, grain, f); });
+    }
+}
+
+#endif // THREADPOOL_H